@@ -0,0 +1,38 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: codes.h                                                         */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - messages of the ARDF foxes                                            */
+/*     used only at build time: the generator encodes them into morse code   */
+/*     and converts them into the keying schedule tables of the firmware     */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - separated from main.c                                     */
+/*               - plain text messages instead of the code patterns          */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef __CODES_H__
+#define __CODES_H__
+
+// messages in DIP_CODE_VALUE order, sent as a single word, with the word
+// space after it: letters, digits and / ? = , . are allowed, a space is
+// sent as a word space within the message
+#define CODE_MESSAGES { "MO", "MOE", "MOI", "MOS", "MOH", "MO5", "S" }
+
+// names of the schedule tables in keying.h
+#define CODE_NAMES { "MO", "MOE", "MOI", "MOS", "MOH", "MO5", "S" }
+
+// the beacon message (callsign, beacon ID) is given at build time by the
+// MESSAGE make variable, and selected by the code value DIP_CODE_MSG
+
+#endif /*__CODES_H__*/
@@ -18,6 +18,24 @@
 /* Change history:                                                           */
 /*                                                                           */
 /*   2023.09.25: - separated from main.c                                     */
+/*   2026.10.16: - tickless mode timing                                      */
+/*               - power-down in the off-period                              */
+/*               - system clock scaling                                      */
+/*               - exact sign length for any code speed                      */
+/*               - beacon message code value                                 */
+/*               - port value computed a tick ahead                          */
+/*               - LTC6903 control words                                     */
+/*               - DIP switch settle time for sampling                       */
+/*               - cycle resume after a warm reset                           */
+/*               - clock calibration against a reference pulse train         */
+/*               - LED pulse width timed by Timer0                           */
+/*               - event schedule windows                                    */
+/*               - telemetry records and software UART timing                */
+/*               - DIP switch pin map converted to a table at build time     */
+/*               - fixed configuration in place of the switches              */
+/*               - start synchronization input                               */
+/*               - shaped keying by the Timer1 PWM                           */
+/*               - window trace records and EEPROM log blocks                */
 /*                                                                           */
 /*****************************************************************************/
 
@@ -39,10 +57,23 @@
 
 // code speed settings
 // normally 10 WPM for slow speed and 15 WPM for high speed
-#define CODE_SPEED_SLOW 10
-#define CODE_SPEED_FAST 15
+#ifndef CODE_SPEED_SLOW
+  #define CODE_SPEED_SLOW 10
+#endif
+#ifndef CODE_SPEED_FAST
+  #define CODE_SPEED_FAST 15
+#endif
 
-#define TICKS_PER_SIGN(wpm) (60 * TICKS_PER_SECOND / 50 / (wpm))
+// a sign lasts 1.2s / WPM (50 signs in PARIS), it is a fraction of ticks:
+// SIGN_TICKS_NUM / SIGN_TICKS_DEN(wpm), the keying schedule generator places
+// the elements on the nearest ticks, the fraction of the word space is
+// accumulated by the interrupt handler, so any speed is timed exactly
+#define SIGN_TICKS_NUM (60 * TICKS_PER_SECOND)
+#define SIGN_TICKS_DEN(wpm) (50 * (wpm))
+
+// keying schedule entries: key level and length in ticks of one element
+#define KEYING_LEVEL 0x80
+#define KEYING_TICKS 0x7F
 
 // usual ON times (in seconds):
 #define INTERVAL_SHORT 12
@@ -56,6 +87,352 @@
 // in interval mode, mark end of transmission cycle with 2s tone
 #define TXOFF_TICKS (2 * TICKS_PER_SECOND)
 
+// system clock: after the initialization the clock is divided by
+// 2^CLOCK_DIV_LOG2 with CLKPR, the timers are set up for this clock
+#ifdef USE_CLOCK_SCALING
+  #define CLOCK_DIV_LOG2 5
+#else
+  #define CLOCK_DIV_LOG2 0
+#endif
+#define F_CLK (F_CPU >> CLOCK_DIV_LOG2)
+
+// Timer0 prescaler: the smallest one, with which the tick fits in the 8 bit
+// counter, with the clock divided and undivided (scaled back up for SPI)
+#define TIMER0_TICK_CYCLES (F_CLK / TICKS_PER_SECOND)
+#if TIMER0_TICK_CYCLES <= 256
+  #define TIMER0_PRESCALER 1
+  #define TIMER0_CS 0x01
+#elif TIMER0_TICK_CYCLES <= 8 * 256L
+  #define TIMER0_PRESCALER 8
+  #define TIMER0_CS 0x02
+#elif TIMER0_TICK_CYCLES <= 64 * 256L
+  #define TIMER0_PRESCALER 64
+  #define TIMER0_CS 0x03
+#elif TIMER0_TICK_CYCLES <= 256 * 256L
+  #define TIMER0_PRESCALER 256
+  #define TIMER0_CS 0x04
+#else
+  #define TIMER0_PRESCALER 1024
+  #define TIMER0_CS 0x05
+#endif
+#define TIMER0_TICK_COUNTS (TIMER0_TICK_CYCLES / TIMER0_PRESCALER)
+
+#if TIMER0_TICK_COUNTS * TIMER0_PRESCALER * TICKS_PER_SECOND != F_CLK
+  #error "tick period is not a whole number of Timer0 counts"
+#endif
+
+#if CLOCK_DIV_LOG2 == 0
+  #define TIMER0_CS_FAST TIMER0_CS
+#elif (TIMER0_PRESCALER << CLOCK_DIV_LOG2) == 8
+  #define TIMER0_CS_FAST 0x02
+#elif (TIMER0_PRESCALER << CLOCK_DIV_LOG2) == 64
+  #define TIMER0_CS_FAST 0x03
+#elif (TIMER0_PRESCALER << CLOCK_DIV_LOG2) == 256
+  #define TIMER0_CS_FAST 0x04
+#elif (TIMER0_PRESCALER << CLOCK_DIV_LOG2) == 1024
+  #define TIMER0_CS_FAST 0x05
+#else
+  #error "no Timer0 prescaler for the undivided clock"
+#endif
+
+// tickless mode: Timer1 runs free with the largest prescaler and the
+// compare is moved to the next output change, the ticks are counted in
+// 1/8 timer counts, so the 8ms tick needs not be a whole count
+#ifdef USE_TICKLESS
+  // CK/2048 of the undivided clock, CS13:10 selects CK/2^(CS-1)
+  #define TICKLESS_PRESCALER (2048 >> CLOCK_DIV_LOG2)
+  #define TICKLESS_CS (12 - CLOCK_DIV_LOG2)
+  #define TICKLESS_CS_FAST 12
+  #define TICKLESS_TOP 0x3FF
+  #define TICKLESS_COUNTS_X8 (F_CLK * 8 / TICKLESS_PRESCALER / TICKS_PER_SECOND)
+  // longest sleep, the compare must stay within one timer cycle
+  #define TICKLESS_MAX_TICKS ((TICKLESS_TOP * 8) / TICKLESS_COUNTS_X8)
+
+  #if F_CLK * 8 / TICKLESS_PRESCALER % TICKS_PER_SECOND
+    #error "tick period is not a multiple of 1/8 Timer1 count"
+  #endif
+#endif
+
+// power-down in the off-period: the watchdog wakes the MCU in steps of its
+// period, which is measured with Timer0 in the enable period before, the
+// time slept is counted in 1/128 Timer0 counts (0.5us)
+#ifdef USE_POWER_DOWN
+  #ifdef USE_TICKLESS
+    #error "POWER_DOWN keeps the phase on Timer0, it can not be used with TICKLESS"
+  #endif
+  // time units of the power-down
+  #define POWER_COUNT_UNITS 128
+  #define POWER_TICK_UNITS (POWER_COUNT_UNITS * TIMER0_TICK_COUNTS)
+  // watchdog interrupt after 128K cycles of its 128kHz oscillator (1s)
+  #define POWER_DOWN_WDP ((1 << WDP2) | (1 << WDP1))
+  // oscillator start-up after power-down, selected by the fuses
+  // (LFUSE 0xFE: CKSEL0 = 0, SUT1:0 = 11)
+  #define POWER_DOWN_STARTUP_CK 1024
+  #define POWER_DOWN_STARTUP (POWER_DOWN_STARTUP_CK * POWER_COUNT_UNITS / (TIMER0_PRESCALER << CLOCK_DIV_LOG2))
+  // the MCU wakes up at least this many ticks before an output changes
+  #define POWER_DOWN_MARGIN_TICKS 4
+#endif
+
+// cycle resume: the phase is kept in RAM not cleared by a reset, and also
+// written to a ring of EEPROM slots, the ring is walked, so every slot is
+// written once in RESUME_SLOTS saves
+#ifdef USE_RESUME
+  // ticks lost by a reset: the start-up delay selected by the fuses
+  // (LFUSE 0xFE: CKSEL0 = 0, SUT1:0 = 11: 1K CK + 14 CK + 4.1ms), in whole
+  // ticks, the rest of it and the part of the tick before the reset are
+  // made up by the first tick, a whole tick after the start, so the cycle
+  // is resumed within a tick
+  #define RESUME_RESET_CK (1024 + 14)
+  #define RESUME_RESET_US (4100 + RESUME_RESET_CK * 1000000UL / F_CPU)
+  #define RESUME_RESET_TICKS (RESUME_RESET_US * TICKS_PER_SECOND / 1000000)
+  // EEPROM save period, a slot is written every RESUME_SLOTS periods:
+  // the 100000 writes of a slot last for 148 days of operation, on the
+  // 128 bytes of EEPROM of the ATtiny261A for 74 days
+  #define RESUME_SAVE_TICKS (4 * TICKS_PER_SECOND)
+  #if defined(__AVR_ATtiny261A__) || defined(__AVR_ATtiny261__)
+    #define RESUME_SLOTS 16
+  #else
+    #define RESUME_SLOTS 32
+  #endif
+#endif
+
+// clock calibration: with the code switches set to CAL_CODE the pulses of
+// a 1PPS reference on PA4 (PCINT4, its DIP switch open) are timed with
+// Timer0, the error of the clock is saved to the EEPROM and the ticks are
+// corrected by it afterwards
+#ifdef USE_CALIBRATE
+  #ifdef USE_TICKLESS
+    #error "CALIBRATE corrects the Timer0 tick, it can not be used with TICKLESS"
+  #endif
+  #define CAL_CODE 7
+  #define CAL_PIN (1 << 4)
+  // a measurement is CAL_PULSES seconds, its counts are 1000000, so an
+  // error of one count is 1ppm
+  #define CAL_PULSES 64
+  #define CAL_SECOND_COUNTS ((uint32_t)TICKS_PER_SECOND * TIMER0_TICK_COUNTS)
+  #define CAL_COUNTS (CAL_PULSES * CAL_SECOND_COUNTS)
+  #if CAL_PULSES * TICKS_PER_SECOND * TIMER0_TICK_COUNTS != 1000000
+    #error "the calibration shall count 1000000 Timer0 counts"
+  #endif
+  // a pulse further from a second of the one before restarts the measurement
+  #define CAL_MAX_PPM 10000
+  #define CAL_MAX_COUNTS (CAL_SECOND_COUNTS * CAL_MAX_PPM / 1000000)
+#endif
+
+// event schedule: the fox keys only in the windows of the schedule given at
+// build time, in ticks since the power-on, the outputs are off in between,
+// and the MCU is turned off after the last window, a window can set the
+// code, speed and frequency instead of the switches
+#ifdef USE_SCHEDULE
+  #ifdef USE_RESUME
+    #error "the schedule clock starts at reset, SCHEDULE can not be used with RESUME"
+  #endif
+  // a setting left to the switches
+  #define SCHED_DIP 0xFF
+  // end of the last window, if it has none
+  #define SCHED_FOREVER 0xFFFFFFFFUL
+  // the windows are kept in the EEPROM
+  #define SCHED_MAX_WINDOWS 16
+#endif
+
+// battery monitor: the supply of the MCU, taken right from the cells, is
+// measured against the 1.1V bandgap in the ADC noise reduction sleep, once
+// in every off-period, when it is low the TXOFF tone is shortened and the
+// LED blinks slower in the enable period
+#ifdef USE_BATTERY
+  #ifdef USE_TICKLESS
+    #error "the Timer0 counts stopped by the ADC sleep are added back, BATTERY can not be used with TICKLESS"
+  #endif
+  // low below 3.6V (1.2V per cell of a 3 cell pack), back to normal
+  // above 3.7V, the bandgap is only within 10%
+  #define BATT_LOW_MV 3600
+  #define BATT_HYST_MV 100
+  // ADC result of the bandgap with the supply as reference: 1.1V * 1024 / Vcc
+  #define BATT_VBG_MV 1100
+  #define BATT_ADC(mv) ((uint16_t)((uint32_t)BATT_VBG_MV * 1024 / (mv)))
+  #define BATT_LOW_ADC BATT_ADC(BATT_LOW_MV)
+  #define BATT_OK_ADC BATT_ADC(BATT_LOW_MV + BATT_HYST_MV)
+  // ADC clock within 50-200kHz
+  #if F_CLK / 2 <= 200000
+    #define BATT_ADC_PRESCALER 2
+    #define BATT_ADPS 0x01
+  #elif F_CLK / 4 <= 200000
+    #define BATT_ADC_PRESCALER 4
+    #define BATT_ADPS 0x02
+  #elif F_CLK / 8 <= 200000
+    #define BATT_ADC_PRESCALER 8
+    #define BATT_ADPS 0x03
+  #elif F_CLK / 16 <= 200000
+    #define BATT_ADC_PRESCALER 16
+    #define BATT_ADPS 0x04
+  #elif F_CLK / 32 <= 200000
+    #define BATT_ADC_PRESCALER 32
+    #define BATT_ADPS 0x05
+  #elif F_CLK / 64 <= 200000
+    #define BATT_ADC_PRESCALER 64
+    #define BATT_ADPS 0x06
+  #else
+    #define BATT_ADC_PRESCALER 128
+    #define BATT_ADPS 0x07
+  #endif
+  // the I/O clock is stopped for the first conversion after enabling the
+  // ADC (25 ADC cycles), which is dropped while the bandgap settles, and
+  // for the one kept (13 ADC cycles), Timer0 stops with it
+  #define BATT_SLEEP_CYCLES ((25 + 13) * BATT_ADC_PRESCALER)
+  // when low: TXOFF tone and LED period in the enable period
+  #define BATT_TXOFF_TICKS (TICKS_PER_SECOND / 2)
+  #define BATT_LED_TICKS (4 * TICKS_PER_SECOND)
+#endif
+
+// telemetry records, also decoded by the host tools/telemetry.c: a header
+// with the type in the high and the payload size in the low nibble, then
+// the payload, 16 bit values low byte first
+#define TLM_HEADER(type, size) (((type) << 4) | (size))
+#define TLM_TYPE(header) ((header) >> 4)
+#define TLM_SIZE(header) ((header) & 0x0F)
+// reset, payload: MCUSR
+#define TLM_RESET 1
+// switches read, payload: code, speed, enable period, interval and the
+// offset of the fox in the cycle of its set in ticks (16 bit each)
+#define TLM_CONFIG 2
+// enable period started, ended, no payload
+#define TLM_WINDOW_START 3
+#define TLM_WINDOW_STOP 4
+// longest tick interrupt since the last report in CPU cycles (16 bit)
+#define TLM_ISR 5
+// records dropped on a full buffer since the last one sent (8 bit)
+#define TLM_LOST 6
+
+// telemetry: the interrupts put the records in a ring buffer, the main loop
+// sends them between the ticks with a software UART on the USI DO pin
+// (PB1), its switch must be open, the line is idle on its pull-up
+#ifdef USE_TELEMETRY
+  #ifdef USE_TICKLESS
+    #error "TELEMETRY is sent between the Timer0 ticks, it can not be used with TICKLESS"
+  #endif
+  #define TLM_TX (1 << 1)
+  // ring buffer size, a power of 2
+  #define TLM_RING_SIZE 32
+  // 8N1 frames at the undivided clock, every bit is a USIDR write and a
+  // _delay_loop_1() of 3 cycles per iteration, TLM_BIT_CYCLES around it
+  #define TLM_BAUD 9600
+  #define TLM_BIT_CYCLES 9
+  #define TLM_BIT_LOOPS ((F_CPU / TLM_BAUD - TLM_BIT_CYCLES + 1) / 3)
+  #if TLM_BIT_LOOPS < 1 || TLM_BIT_LOOPS > 255
+    #error "TLM_BAUD is out of the range of the bit delay"
+  #endif
+  // a byte is sent only if it ends before the next tick, a tick corrected
+  // by CALIBRATE is a count shorter
+  #define TLM_BYTE_COUNTS ((10UL * TICKS_PER_SECOND * TIMER0_TICK_COUNTS + TLM_BAUD - 1) / TLM_BAUD)
+  #define TLM_SEND_COUNTS (TIMER0_TICK_COUNTS - 2 - TLM_BYTE_COUNTS)
+  // Timer1 counts the CPU cycles of the tick interrupt, 10 bit free running
+  #define TLM_CYCLE_TOP 0x3FF
+#endif
+
+// window trace records, also decoded by the host tools/trace.c: a window
+// is summed up at its end, as its start in ticks since the start of the
+// window before, or of the trace, its length in ticks, the key edges in it
+// and a signature of their ticks from its start, a changed keying changes
+// it; a window the same as the last one written, an interval after the
+// window before, is only counted in a run record
+// window, 9 bytes: start (16 bit, TRACE_MAX_TICKS for that many or more),
+// length, edges and signature (16 bit each)
+#define TRACE_WINDOW 0x01
+#define TRACE_MAX_TICKS 0xFFFF
+// window already open at the start of the trace, as TRACE_WINDOW, its start
+// is at the start of the trace
+#define TRACE_PARTIAL 0x02
+// run, 2 bytes: windows the same as the last TRACE_WINDOW, counted on in the
+// EEPROM up to TRACE_RUN_MAX
+#define TRACE_RUN 0x03
+#define TRACE_RUN_MAX 255
+// start at a reset, a sync edge or a schedule window, the time counts from
+// the first tick, payload: MCUSR, TRACE_SYNC or TRACE_SCHED, the interval
+// counter before the first tick (16 bit)
+#define TRACE_START 0x00
+#define TRACE_SYNC 0x80
+#define TRACE_SCHED 0x40
+// phase of the fox at a sync edge, before its start record, the drift from
+// the sync reference: the interval counter (16 bit) and the Timer0 count
+// at the edge, TRACE_PHASE_UNKNOWN in power-down, with the ticks of the
+// last wake-up
+#define TRACE_PHASE 0x04
+#define TRACE_PHASE_UNKNOWN 0xFF
+// records dropped on a full buffer, no payload
+#define TRACE_LOST 0x7E
+// switches read, payload: as TLM_CONFIG
+#define TRACE_CONFIG 0x7F
+#define TRACE_SIZE(record) \
+  ((record) == TRACE_WINDOW || (record) == TRACE_PARTIAL || (record) == TRACE_CONFIG ? 9 : \
+   (record) == TRACE_START || (record) == TRACE_PHASE ? 4 : (record) == TRACE_RUN ? 2 : 1)
+// EEPROM log: a ring of TRACE_BLOCKS blocks, every block is its number,
+// the bytes of the records used and the records, a record is not split
+// between two blocks, the newest block has the largest number; a start
+// takes 3 blocks with up to 510 windows the same, and a block more for
+// every 1785 windows, so the default log holds a power-on and a sync edge
+// in an event of 3 hours at the shortest interval, one start on the
+// ATtiny261A
+#ifndef TRACE_BLOCKS
+  #if defined(__AVR_ATtiny261A__) || defined(__AVR_ATtiny261__)
+    #define TRACE_BLOCKS 4
+  #else
+    #define TRACE_BLOCKS 8
+  #endif
+#endif
+#define TRACE_BLOCK_SIZE 16
+#define TRACE_BLOCK_DATA (TRACE_BLOCK_SIZE - 2)
+
+// window trace: the tick interrupt sums up every transmit window, and puts
+// a record at its end in a ring buffer, the main loop writes it to the
+// EEPROM log in the off-period after it, in continuous keying only the
+// start and the settings are recorded
+#ifdef USE_TRACE
+  #ifdef USE_TICKLESS
+    #error "TRACE counts the Timer0 ticks, it can not be used with TICKLESS"
+  #endif
+  #ifdef USE_RESUME
+    #error "the RESUME ring and the TRACE log do not fit the EEPROM together, TRACE can not be used with RESUME"
+  #endif
+  #if TRACE_BLOCKS < 2 || TRACE_BLOCKS > 127
+    #error "TRACE_BLOCKS shall be 2 to 127"
+  #endif
+  // ring buffer size, a power of 2, the records of a window and a start
+  #define TRACE_RING_SIZE 32
+#endif
+
+// start synchronization: a falling edge on the sync input, a line idle
+// high on the pull-ups of the foxes, pulled low by a master unit or a
+// starter, restarts Timer0 and the cycle of the set at the edge, so the
+// foxes on the same line tick together, the pin change interrupt is
+// disabled for SYNC_LOCKOUT_TICKS after an edge, the bounces of a starter
+// are ignored
+#ifdef USE_SYNC
+  #ifdef USE_TICKLESS
+    #error "SYNC restarts the Timer0 tick, it can not be used with TICKLESS"
+  #endif
+  // board version 1: PA3 (PCINT3), the interval switch of the sets left
+  // open, version 2: PA0 (PCINT0), with no switch
+  #if BOARD_VERSION == 2
+    #define SYNC_PIN (1 << 0)
+  #else
+    #define SYNC_PIN (1 << 3)
+  #endif
+  #define SYNC_LOCKOUT_TICKS TICKS_PER_SECOND
+  // woken from power-down by the edge, the Timer0 counts of the oscillator
+  // start-up are already elapsed when the counter is written
+  #ifdef USE_POWER_DOWN
+    #define SYNC_WAKE_COUNTS ((POWER_DOWN_STARTUP + POWER_COUNT_UNITS / 2) / POWER_COUNT_UNITS)
+  #endif
+#else
+  #define SYNC_PIN 0
+#endif
+
+// port A as read for the switches, the sync input reads as an open switch
+#define DIP_PINA (PINA | SYNC_PIN)
+
+// start value of the CRC-8 of the states saved in RAM and EEPROM
+#define CRC8_INIT 0xFF
+
 
 // output bits
 #define OUTPUT_PORT PORTB
@@ -68,6 +445,9 @@
     // code is keyed using key pin
     #define OUTPUT_KEY_PIN 0
     #define OUTPUT_KEY (1 << OUTPUT_KEY_PIN)
+    // the key pin is /OC1A, the Timer1 PWM drives it only with OC1A, the
+    // USI DO pin, so the option has no effect on this board
+    #undef USE_KEY_SHAPE
 
     // LTC6903 is connected to USI in SPI mode
     // define pin settings for this
@@ -78,6 +458,14 @@
     #define OSC_SEN_PIN 3
     #define OSC_SEN (1 << OSC_SEN_PIN)
 
+    // control word: OCT3:0 octave 11, DAC9:0 from the frequency setting,
+    // CNF1:0 10 (CLKN disabled)
+    #define LTC6903_OCT 11
+    #define LTC6903_CNF 0x02
+    #define LTC6903_WORD(dac) (((uint16_t)LTC6903_OCT << 12) | ((uint16_t)(dac) << 2) | LTC6903_CNF)
+    // both outputs off, the oscillator powered down
+    #define LTC6903_OFF (((uint16_t)LTC6903_OCT << 12) | 0x03)
+
 
 // basic fixed frequency variant
 #else
@@ -91,36 +479,116 @@
     // aditional LED is used to signal when TX is enabled
     #define OUTPUT_LED_PIN 6
     #define OUTPUT_LED (1 << OUTPUT_LED_PIN)
-    #define LED_ON() OUTPUT_PORT |= OUTPUT_LED
-    #define LED_OFF() OUTPUT_PORT &= ~OUTPUT_LED
 
 #endif
 
 #ifdef USE_LED
     #define ENABLED_LED_TICKS (TICKS_PER_SECOND)
     #define DISABLED_LED_TICKS (60 * TICKS_PER_SECOND)
+    #define OUTPUT_MASK (OUTPUT_ENABLE | OUTPUT_KEY | OUTPUT_LED)
+#else
+    #define OUTPUT_MASK (OUTPUT_ENABLE | OUTPUT_KEY)
+    // the option has no effect on the boards without LED
+    #undef USE_LED_PULSE
 #endif
 
+// LED pulse: the LED turned on by a tick is turned off by the Timer0
+// compare match B of the same tick, after LED_PULSE_US, instead of the next
+// tick, the pulse is a whole number of Timer0 counts
+#ifdef USE_LED_PULSE
+  #ifdef USE_TICKLESS
+    #error "LED_PULSE is timed by the Timer0 tick, it can not be used with TICKLESS"
+  #endif
+  #ifndef LED_PULSE_US
+    #define LED_PULSE_US 500
+  #endif
+  #define LED_PULSE_COUNTS \
+    (((uint32_t)LED_PULSE_US * TICKS_PER_SECOND * TIMER0_TICK_COUNTS + 500000) / 1000000)
+  // the match shall come before the end of a tick shortened by CALIBRATE
+  #if LED_PULSE_US * TICKS_PER_SECOND * TIMER0_TICK_COUNTS < 500000 || \
+      LED_PULSE_US * TICKS_PER_SECOND * TIMER0_TICK_COUNTS >= (TIMER0_TICK_COUNTS - 1) * 1000000 - 500000
+    #error "LED_PULSE_US shall be between a Timer0 count and a tick"
+  #endif
+#endif
 
-#define OUTPUT(out) OUTPUT_PORT = (OUTPUT_PORT & ~(OUTPUT_ENABLE | OUTPUT_KEY)) | ((out) & (OUTPUT_ENABLE | OUTPUT_KEY))
+// shaped keying: the key pin (PB3, OC1B) is driven by the Timer1 phase and
+// frequency correct PWM, at every edge the duty steps through a raised
+// cosine of KEY_SHAPE_STEPS levels in KEY_SHAPE_US, a PWM period a step
+// the step interrupt takes a few dozen cycles, a step is 128 cycles at
+// least and the ramp ends within 7/8 of the tick of its edge, so the tick
+// interrupt is never delayed by it; Timer1 runs only for the ramps
+#ifdef USE_KEY_SHAPE
+  #ifdef USE_TICKLESS
+    #error "KEY_SHAPE needs Timer1, it can not be used with TICKLESS"
+  #endif
+  #ifdef USE_TELEMETRY
+    #error "KEY_SHAPE needs Timer1, it can not be used with TELEMETRY"
+  #endif
+  #ifdef USE_CLOCK_SCALING
+    #error "KEY_SHAPE steps the ramp at the full clock, it can not be used with CLOCK_SCALING"
+  #endif
+  #if OUTPUT_KEY_PIN != 3
+    #error "KEY_SHAPE needs the key on the OC1B pin"
+  #endif
+  #ifndef KEY_SHAPE_US
+    #define KEY_SHAPE_US 5000
+  #endif
+  #define KEY_SHAPE_STEPS 32
+  #define KEY_SHAPE_STEP_CYCLES (F_CLK / 1000 * KEY_SHAPE_US / 1000 / KEY_SHAPE_STEPS)
+  // the smallest prescaler with which a PWM period of 2 * TOP counts fits
+  // the 8 bit TOP
+  #if KEY_SHAPE_STEP_CYCLES <= 2 * 255
+    #define KEY_SHAPE_PRESCALER 1
+    #define KEY_SHAPE_CS 0x01
+  #elif KEY_SHAPE_STEP_CYCLES <= 4 * 255
+    #define KEY_SHAPE_PRESCALER 2
+    #define KEY_SHAPE_CS 0x02
+  #elif KEY_SHAPE_STEP_CYCLES <= 8 * 255
+    #define KEY_SHAPE_PRESCALER 4
+    #define KEY_SHAPE_CS 0x03
+  #else
+    #define KEY_SHAPE_PRESCALER 8
+    #define KEY_SHAPE_CS 0x04
+  #endif
+  #define KEY_SHAPE_TOP ((KEY_SHAPE_STEP_CYCLES + KEY_SHAPE_PRESCALER) / (2 * KEY_SHAPE_PRESCALER))
+  #if KEY_SHAPE_TOP < 64
+    #error "KEY_SHAPE_US is too short, a step shall be 128 cycles at least"
+  #endif
+  #if KEY_SHAPE_TOP > 255 || \
+      KEY_SHAPE_STEPS * 2 * KEY_SHAPE_TOP * KEY_SHAPE_PRESCALER > TIMER0_TICK_CYCLES * 7 / 8
+    #error "KEY_SHAPE_US is too long, the ramp shall end in the tick of its edge"
+  #endif
+  // level of the ramp table, from the raised cosine in 1/256
+  #define KEY_SHAPE_LEVEL(c) ((uint8_t)(((uint16_t)(c) * KEY_SHAPE_TOP + 128) >> 8))
+#endif
 
 
-// DIP switch settings
-// this heavily depends on board variants
+// the port value of the next tick is computed a tick ahead, and kept in an
+// I/O register, so it is written by the first instructions of the tick
+// interrupt, at the same time after the timer event on every path
+#define OUTPUT_NEXT GPIOR0
+#define OUTPUT(out) OUTPUT_NEXT = (OUTPUT_PORT & ~OUTPUT_MASK) | ((out) & OUTPUT_MASK)
+#define OUTPUT_WRITE() OUTPUT_PORT = OUTPUT_NEXT
 
-// v1 board, basic operation
 
+// DIP switch sampling: the port A pull-ups are turned on only for the
+// sampling, the time the switch lines need to charge to a high level
+// through the pull-ups, in microseconds, and in iterations of the 3 cycle
+// _delay_loop_1() at the tick clock
+#ifdef USE_DIP_SCAN
+  #define DIP_SETTLE_US 20
+  #define DIP_SETTLE_LOOPS ((F_CLK / 1000 * DIP_SETTLE_US / 1000 + 2) / 3 + 1)
+#endif
 
-#define DIP_BIT(port, pin) (PIN##port & (1 << pin))
-#define DIP_BIT_EXP(port, pin) DIP_BIT(port, pin)
-#define DIP_BIT_x(name, pos) ((DIP_BIT_EXP(DIP_##name##_BIT##pos##_PORT, DIP_##name##_BIT##pos##_PIN) >> DIP_##name##_BIT##pos##_PIN) << pos)
-#define DIP_BITS_1(name) (DIP_BIT_x(name, 0))
-#define DIP_BITS_2(name) (DIP_BIT_x(name, 1) | DIP_BIT_x(name, 0))
-#define DIP_BITS_3(name) (DIP_BIT_x(name, 2) | DIP_BIT_x(name, 1) | DIP_BIT_x(name, 0))
-#define DIP_BITS( count, name ) DIP_BITS_##count( name )
-#define DIP_BITS_EXP(count, name) DIP_BITS(count, name)
+// DIP switch settings
+// this heavily depends on board variants
+// every setting is given by its bits, from bit 0, as the port (A or B) and
+// the pin, gen_dip converts the pin map to the table read by dip_get()
+// (dip.h), DIP(name) reads the value of a setting
+#define DIP(name) dip_get(DIP_##name##_FIRST, DIP_##name##_BITS)
 
-#define DIP(name) DIP_BITS_EXP(DIP_##name##_BITS, name)
+// port B flag of the pin table entries, with the pin number in bits 2:0
+#define DIP_PORT_B 0x80
 
 #if BOARD_VERSION == 2
 
@@ -154,14 +622,8 @@
 #define DIP_INTERVAL_BIT1_PORT A
 #define DIP_INTERVAL_BIT1_PIN  7
 
-#define SET_INTERVAL_VALUE(interval, period) \
-  switch (DIP(INTERVAL))                     \
-  {                                          \
-    case 1: interval = 2 * period; break;    \
-    case 2: interval = 3 * period; break;    \
-    case 3: interval = 5 * period; break;    \
-    default: interval = 0;                   \
-  }
+// foxes of the set, indexed by the interval switches, 0 for continuous
+#define DIP_INTERVAL_FOXES { 0, 2, 3, 5 }
 
 // frequency DAC settings
 #define DIP_FREQ_BITS 3
@@ -173,6 +635,8 @@
 #define DIP_FREQ_BIT0_PIN  4
 
 #define PORTB_DIP_PINS (( 1 << 1 ) | ( 1 << 6))
+// switch pins of port B with no other use, PB1 is the USI DO
+#define PORTB_DIP_ONLY_PINS ( 1 << 6 )
 
 #else /* board version 1: basic fixed controller */
 
@@ -201,7 +665,7 @@
 #define DIP_INTERVAL_LENGTH_BIT0_PORT A
 #define DIP_INTERVAL_LENGTH_BIT0_PIN  2
 
-#define DIP_INTERVAL_BITS 2
+#define DIP_INTERVAL_BITS 3
 #define DIP_INTERVAL_BIT0_PORT A
 #define DIP_INTERVAL_BIT0_PIN  0
 #define DIP_INTERVAL_BIT1_PORT A
@@ -209,17 +673,12 @@
 #define DIP_INTERVAL_BIT2_PORT A
 #define DIP_INTERVAL_BIT2_PIN  3
 
-#define SET_INTERVAL_VALUE(interval, period) \
-  switch (DIP(INTERVAL))                     \
-  {                                          \
-    case 4: interval = 2 * period; break;    \
-    case 5: interval = 3 * period; break;    \
-    case 6: interval = 4 * period; break;    \
-    case 7: interval = 5 * period; break;    \
-    default: interval = 0;                   \
-  }
+// foxes of the set, indexed by the interval switches, 0 for continuous
+#define DIP_INTERVAL_FOXES { 0, 0, 0, 0, 2, 3, 4, 5 }
 
 #define PORTB_DIP_PINS (( 1 << 1 ) | ( 1 << 0))
+// switch pins of port B with no other use, PB1 is the USI DO
+#define PORTB_DIP_ONLY_PINS ( 1 << 0 )
 
 #endif
 
@@ -232,15 +691,44 @@ typedef enum
     DIP_CODE_MOS,
     DIP_CODE_MOH,
     DIP_CODE_MO5,
-    DIP_CODE_S
+    DIP_CODE_S,
+    DIP_CODE_MSG
 } DIP_CODE_VALUE;
 
-
-
-
-
-
-
-
+// fixed configuration: the settings are given at build time in place of
+// the switches (FIXED_CODE as DIP_CODE_VALUE, FIXED_SPEED, FIXED_LENGTH,
+// FIXED_FOXES of the set, 0 for continuous keying, FIXED_FREQ and the
+// FIXED_KEY_LEVEL and FIXED_ENABLE_LEVEL of the outputs when on), and every
+// setting is a constant, the switch pins are driven low
+#ifdef USE_FIXED
+  #define FIXED_SLOW 0
+  #define FIXED_FAST 1
+  #define FIXED_LONG 0
+  #define FIXED_SHORT 1
+  #if defined(USE_DIP_SCAN) || defined(USE_CALIBRATE) || defined(USE_SCHEDULE)
+    #error "FIXED does not read the switches, it can not be combined with DIP_SCAN, CALIBRATE or SCHEDULE"
+  #endif
+  #if FIXED_FOXES != 0 && (FIXED_FOXES < 2 || FIXED_FOXES > 5)
+    #error "FIXED_FOXES shall be 2 to 5, or 0 for continuous keying"
+  #endif
+  #if FIXED_FREQ < 0 || FIXED_FREQ > 7
+    #error "FIXED_FREQ shall be 0 to 7"
+  #endif
+  // position of the fox in its set, as in the DIP_POSITIONS table
+  #define FIXED_POSITION (FIXED_CODE >= DIP_CODE_MOE && FIXED_CODE <= DIP_CODE_MO5 ? FIXED_CODE - DIP_CODE_MOE : 0)
+  #if FIXED_FOXES
+    #define FIXED_PERIOD INTERVAL_COUNT(FIXED_LENGTH == FIXED_SHORT ? INTERVAL_SHORT : INTERVAL_LONG)
+    #define FIXED_OFFSET ((FIXED_FOXES - FIXED_POSITION % FIXED_FOXES) % FIXED_FOXES * FIXED_PERIOD)
+  #else
+    #define FIXED_PERIOD 0
+    #define FIXED_OFFSET 0
+  #endif
+  #define FIXED_INTERVAL (FIXED_FOXES * FIXED_PERIOD)
+  #ifdef USE_LEVEL_SETTING
+    #define FIXED_OUTPUT_SET ((FIXED_KEY_LEVEL ? 0 : OUTPUT_KEY) | (FIXED_ENABLE_LEVEL ? 0 : OUTPUT_ENABLE))
+  #else
+    #define FIXED_OUTPUT_SET 0
+  #endif
+#endif
 
 #endif /*__CONFIG_H__*/
@@ -0,0 +1,65 @@
+#####################################################################
+#  Build time generated tables of the firmware
+#  included by the firmware and the simulator makefiles
+#  Kertész Csaba-Zoltán
+#  csaba.kertesz@etc.unitbv.ro
+#####################################################################
+
+# expected settings of the including makefile:
+#   GENSRC: directory of the firmware sources
+#   GENDIR: output directory of the generators and generated files
+#   CDEFS:  compile time definitions of the build
+#   MESSAGE: beacon message
+#   SCHEDULE: windows of the event schedule
+#   FIXED_DEFS: definitions of the fixed configuration
+
+# host compiler for the generators
+HOSTCC = cc
+HOSTCFLAGS = -O2 -Wall -Wextra -Werror -std=gnu17 \
+             $(addprefix -D,$(CDEFS)) -DF_CPU=$(F_CPU) -I$(GENSRC)
+
+# generated headers
+GEN = $(GENDIR)/keying.h $(GENDIR)/schedule.h $(GENDIR)/dip.h
+
+# inputs of every generator
+GENDEPS = $(GENSRC)/config.h $(GENSRC)/codes.h
+
+$(GENDIR)/gen_%: $(GENSRC)/tools/gen_%.c $(GENDEPS)
+	echo "(HOSTCC) $<"
+	$(HOSTCC) $(HOSTCFLAGS) $< -o $@
+
+# the beacon message is kept in a file, which is written only when the
+# message changes, so the tables are generated again only then
+$(GENDIR)/message.txt: FORCE
+	echo '$(MESSAGE)' | cmp -s - $@ || echo '$(MESSAGE)' > $@
+
+# the event schedule is kept in a file the same way
+$(GENDIR)/schedule.txt: FORCE
+	echo '$(SCHEDULE)' | cmp -s - $@ || echo '$(SCHEDULE)' > $@
+
+# the fixed configuration is kept in a file the same way, the keying
+# schedule generator is built with it, and built again when it changes
+$(GENDIR)/fixed.txt: FORCE
+	echo '$(FIXED_DEFS)' | cmp -s - $@ || echo '$(FIXED_DEFS)' > $@
+
+$(GENDIR)/gen_keying: $(GENDIR)/fixed.txt
+
+# the keying schedule generator also writes its verification report
+$(GENDIR)/keying.h: $(GENDIR)/gen_keying $(GENDIR)/message.txt
+	echo "(GEN) $@"
+	$< $(GENDIR)/keying.txt $(GENDIR)/message.txt > $@.tmp && $(MOVE) $@.tmp $@
+
+# the beacon message can be selected by the windows of the event schedule
+$(GENDIR)/schedule.h: $(GENDIR)/gen_schedule $(GENDIR)/message.txt $(GENDIR)/schedule.txt
+	echo "(GEN) $@"
+	$< $(GENDIR)/message.txt $(GENDIR)/schedule.txt > $@.tmp && $(MOVE) $@.tmp $@
+
+$(GENDIR)/%.h: $(GENDIR)/gen_%
+	echo "(GEN) $@"
+	$< > $@.tmp && $(MOVE) $@.tmp $@
+
+.PRECIOUS: $(GENDIR)/gen_%
+
+FORCE:
+
+.PHONY: FORCE
@@ -16,6 +16,29 @@
 /*                                                                           */
 /*   21.05.2018: - first implementation                                      */
 /*   2022.05.06: - converted to programmable frequency generator             */
+/*   2026.10.16: - host simulation build, start keying with a whole word     */
+/*               - precomputed keying schedule tables                        */
+/*               - word space computed at build time                         */
+/*               - tickless mode with Timer1                                 */
+/*               - power-down with watchdog wake-up in the off-period        */
+/*               - system clock scaling                                      */
+/*               - word space remainder accumulated for exact timing         */
+/*               - beacon message given at build time                        */
+/*               - outputs computed ahead, written first in the interrupt    */
+/*               - precomputed LTC6903 words, retuned in the off-period      */
+/*               - DIP switches sampled at the window boundaries             */
+/*               - cycle phase resumed after a warm reset                    */
+/*               - clock calibrated against a reference pulse train          */
+/*               - LED pulse turned off by the Timer0 compare match B        */
+/*               - event schedule with a 32 bit tick clock                   */
+/*               - battery measured in the ADC noise reduction sleep         */
+/*               - telemetry ring buffer sent by a software UART             */
+/*               - DIP switches decoded by lookup tables                     */
+/*               - USI clock strobed in a loop                               */
+/*               - fixed configuration with the settings folded as constants */
+/*               - start synchronization input restarting the tick           */
+/*               - key edges shaped by the Timer1 PWM                        */
+/*               - window trace in a ring buffer, written to an EEPROM log   */
 /*                                                                           */
 /*****************************************************************************/
 
@@ -25,78 +48,2535 @@
 #include <avr/pgmspace.h>
 #include <avr/interrupt.h>
 #include <avr/sleep.h>
+#ifdef USE_POWER_DOWN
+#include <avr/wdt.h>
+#endif
+#if defined(USE_DIP_SCAN) || defined(USE_TELEMETRY)
+#include <util/delay_basic.h>
+#endif
+#if defined(USE_RESUME) || defined(USE_CALIBRATE) || defined(USE_SCHEDULE) || defined(USE_TRACE)
+#include <avr/eeprom.h>
+#endif
+#if defined(USE_RESUME) || defined(USE_CALIBRATE)
+#include <util/crc16.h>
+#endif
+#if defined(USE_RESUME) || defined(USE_CALIBRATE) || defined(USE_TELEMETRY) || defined(USE_TRACE)
+#include <stddef.h>
+#endif
 #include <stdint.h>
 
-#include "config.h"
+#include "config.h"
+
+/**** local types ************************************************************/
+
+#ifdef USE_RESUME
+// cycle state kept over a reset: the interval counter, the port A switches
+// it belongs to, the number of the save for the EEPROM ring and the CRC-8
+// of the fields before it
+typedef struct
+{
+  uint16_t interval_ticks;
+  uint8_t dips;
+  uint8_t seq;
+  uint8_t crc;
+} RESUME_STATE;
+#endif
+
+#ifdef USE_CALIBRATE
+// clock calibration saved in EEPROM: tick correction in 1/65536 Timer0
+// counts, error of the clock against the reference in ppm, and the CRC-8
+// of the fields before it
+typedef struct
+{
+  int32_t step;
+  int16_t error;
+  uint8_t crc;
+} CAL_STATE;
+#endif
+
+#ifdef USE_SCHEDULE
+// window of the event schedule: start and end in ticks since the power-on,
+// code, speed and frequency, SCHED_DIP if set by the switches
+typedef struct
+{
+  uint32_t start;
+  uint32_t end;
+  uint8_t code;
+  uint8_t speed;
+  uint8_t freq;
+} SCHED_WINDOW;
+#endif
+
+#if defined(USE_TELEMETRY) || defined(USE_TRACE)
+// payload of the TLM_CONFIG and TRACE_CONFIG records
+typedef struct
+{
+  uint8_t code;
+  uint8_t speed;
+  uint16_t enable_period;
+  uint16_t interval;
+  uint16_t offset;
+} CONFIG_DATA;
+#endif
+
+#ifdef USE_TRACE
+// block of the EEPROM trace log: number of the block, bytes of the records
+// used, the records
+typedef struct
+{
+  uint8_t seq;
+  uint8_t used;
+  uint8_t data[TRACE_BLOCK_DATA];
+} TRACE_BLOCK;
+
+// payload of the TRACE_WINDOW and TRACE_PARTIAL records
+typedef struct
+{
+  uint16_t start;
+  uint16_t length;
+  uint16_t edges;
+  uint16_t signature;
+} TRACE_SUM;
+#endif
+
+/**** local function prototypes **********************************************/
+void init_uc(void);
+#ifndef USE_FIXED
+static uint8_t dip_get(uint8_t first, uint8_t bits);
+#endif
+static uint16_t dip_read(void);
+#ifdef USE_DIP_SCAN
+static void dip_scan(void);
+#endif
+#if defined(USE_RESUME) || defined(USE_CALIBRATE)
+static uint8_t crc8(const void *data, uint8_t size);
+#endif
+#ifdef USE_RESUME
+static inline void resume_tick(uint16_t ticks, uint8_t elapsed) __attribute__((always_inline));
+static void resume_save(void);
+static void resume_init(void);
+#endif
+#ifdef USE_CALIBRATE
+static inline void cal_pulse(void) __attribute__((always_inline));
+static void cal_init(void);
+static void cal_save(void);
+#endif
+#ifdef USE_SYNC
+static inline void sync_pulse(void) __attribute__((always_inline));
+#endif
+#ifdef USE_KEY_SHAPE
+static inline void shape_edge(void) __attribute__((always_inline));
+#endif
+#ifdef USE_SCHEDULE
+static void sched_load(void);
+static void sched_event(void);
+static void sched_read_ahead(void);
+#endif
+#ifdef USE_BATTERY
+static void batt_measure(void);
+#endif
+#ifdef USE_TELEMETRY
+static void tlm_event(uint8_t type, const void *data, uint8_t size);
+static void tlm_isr_report(void);
+static inline uint16_t tlm_cycles(void) __attribute__((always_inline));
+static void tlm_send(uint8_t byte);
+static void tlm_drain(void);
+#endif
+#ifdef USE_TRACE
+static uint8_t trace_event(uint8_t record, const void *data, uint8_t size);
+static void trace_edge(uint8_t levels);
+static inline void trace_tick(void) __attribute__((always_inline));
+#ifdef USE_POWER_DOWN
+static void trace_skip(uint16_t ticks);
+#endif
+#ifdef USE_SYNC
+static void trace_phase(uint16_t ticks, uint8_t count);
+#endif
+static void trace_start(uint8_t flags);
+static void trace_init(void);
+static void trace_flush(void);
+#endif
+static inline void keying_tick(void) __attribute__((always_inline));
+#if defined(USE_TICKLESS) || defined(USE_POWER_DOWN)
+static uint16_t keying_next_event(uint16_t limit);
+static void keying_skip(uint16_t ticks);
+#endif
+static inline void clock_set(uint8_t div) __attribute__((always_inline));
+static inline void clock_fast(void) __attribute__((always_inline));
+static inline void clock_slow(void) __attribute__((always_inline));
+#ifdef USE_LTC6903
+static void ltc_write(uint16_t word);
+#endif
+#ifdef USE_POWER_DOWN
+static void wdt_start(void);
+static void wdt_stop(void);
+static void power_resume(uint32_t elapsed);
+static inline void power_tick(void) __attribute__((always_inline));
+#endif
+
+/**** constants **************************************************************/
+
+// keying schedule tables, generated from codes.h
+#include "keying.h"
+
+#ifndef USE_FIXED
+// DIP switch decoding tables, generated from the pin map of config.h
+#include "dip.h"
+
+const PROGMEM uint8_t dip_pins[DIP_PIN_COUNT] = DIP_PINS;
+const PROGMEM uint16_t dip_intervals[2][1 << DIP_INTERVAL_BITS] = DIP_INTERVALS;
+const PROGMEM uint8_t dip_positions[DIP_CODE_MSG + 1] = DIP_POSITIONS;
+#endif
+
+#ifdef USE_SCHEDULE
+// windows of the event schedule, generated from SCHEDULE
+#include "schedule.h"
+
+// schedule states: waiting for a window, keying in a window, turned off
+// after the last window
+#define SCHED_WAIT 0
+#define SCHED_RUN 1
+#define SCHED_OFF 2
+#endif
+
+#ifdef USE_BATTERY
+// LED period in the enable period, slower on a low battery
+#define LED_PERIOD (batt_low ? BATT_LED_TICKS : ENABLED_LED_TICKS)
+#else
+#define LED_PERIOD ENABLED_LED_TICKS
+#endif
+
+#if defined(USE_CALIBRATE) && defined(KEYING_MESSAGE)
+  #error "the code value of the beacon message selects the calibration"
+#endif
+
+#ifdef USE_KEY_SHAPE
+// key ramp levels of the PWM, a raised cosine from low to high: a rising
+// ramp steps through the levels after the first one, a falling ramp
+// through the levels before the last one backwards, 0 and TOP hold the pin
+// low and high
+const PROGMEM uint8_t shape_levels[KEY_SHAPE_STEPS + 1] =
+{
+  KEY_SHAPE_LEVEL(0),   KEY_SHAPE_LEVEL(1),   KEY_SHAPE_LEVEL(2),   KEY_SHAPE_LEVEL(6),
+  KEY_SHAPE_LEVEL(10),  KEY_SHAPE_LEVEL(15),  KEY_SHAPE_LEVEL(22),  KEY_SHAPE_LEVEL(29),
+  KEY_SHAPE_LEVEL(37),  KEY_SHAPE_LEVEL(47),  KEY_SHAPE_LEVEL(57),  KEY_SHAPE_LEVEL(68),
+  KEY_SHAPE_LEVEL(79),  KEY_SHAPE_LEVEL(91),  KEY_SHAPE_LEVEL(103), KEY_SHAPE_LEVEL(115),
+  KEY_SHAPE_LEVEL(128), KEY_SHAPE_LEVEL(141), KEY_SHAPE_LEVEL(153), KEY_SHAPE_LEVEL(165),
+  KEY_SHAPE_LEVEL(177), KEY_SHAPE_LEVEL(188), KEY_SHAPE_LEVEL(199), KEY_SHAPE_LEVEL(209),
+  KEY_SHAPE_LEVEL(219), KEY_SHAPE_LEVEL(227), KEY_SHAPE_LEVEL(234), KEY_SHAPE_LEVEL(241),
+  KEY_SHAPE_LEVEL(246), KEY_SHAPE_LEVEL(250), KEY_SHAPE_LEVEL(254), KEY_SHAPE_LEVEL(255),
+  KEY_SHAPE_LEVEL(256)
+};
+
+// Timer1 runs only for a key ramp
+#define SHAPE_BUSY() (TCCR1B != 0)
+#endif
+
+#ifdef USE_TRACE
+// window of the trace: the enable output, on the board without it the
+// enable period of the interval counter, in the windows of the schedule
+#if OUTPUT_ENABLE
+#define TRACE_IN_WINDOW() (output & OUTPUT_ENABLE)
+#elif defined(USE_SCHEDULE)
+#define TRACE_IN_WINDOW() \
+  (sched_state == SCHED_RUN && (!interval || (uint16_t)(interval_ticks - 1) < enable_period))
+#else
+#define TRACE_IN_WINDOW() (!interval || (uint16_t)(interval_ticks - 1) < enable_period)
+#endif
+
+// levels of the last tick of the trace, the first tick after a start
+#define TRACE_OPEN 0x01
+#define TRACE_KEYED 0x02
+#define TRACE_FIRST 0x80
+#endif
+
+#ifdef USE_POWER_DOWN
+// power states: running on Timer0, running and measuring the watchdog
+// period on Timer0, powered down until a watchdog interrupt
+#define POWER_RUN 0
+#define POWER_CAL 1
+#define POWER_DOWN 2
+#endif
+
+#ifdef USE_PROG_FREQ
+// frequency settings, as LTC6903 control words ready to be shifted out
+const PROGMEM uint16_t frequencies[8] =
+{
+  LTC6903_WORD(803), LTC6903_WORD(810), LTC6903_WORD(813), LTC6903_WORD(820),
+  LTC6903_WORD(824), LTC6903_WORD(827), LTC6903_WORD(834), LTC6903_WORD(837)
+};
+#endif
+
+/**** global variables *******************************************************/
+
+#ifdef USE_FIXED
+// the settings of the fixed configuration, constants folded into the code
+// which reads them
+static const uint8_t * const keying = KEYING_FIXED;
+static const uint16_t enable_period = FIXED_PERIOD;
+static const uint16_t interval = FIXED_INTERVAL;
+static const uint8_t output_set = FIXED_OUTPUT_SET;
+static const uint16_t space = KEYING_FIXED_SPACE;
+static const uint8_t space_rem = KEYING_FIXED_SPACE_REM;
+static const uint8_t space_mod = KEYING_FIXED_SPACE_MOD;
+static const uint8_t lead = KEYING_FIXED_LEAD;
+#else
+const uint8_t* keying;
+uint16_t enable_period;
+uint16_t interval;
+uint8_t output_set;
+uint16_t space;
+uint8_t space_rem;
+uint8_t space_mod;
+uint8_t lead;
+#endif
+const uint8_t* keying_ptr;
+uint8_t output;
+uint16_t interval_ticks;
+uint16_t key_ticks;
+uint8_t space_acc;
+#ifdef USE_LED
+uint16_t led_ticks;
+#endif
+#ifdef USE_PROG_FREQ
+uint16_t frequency;
+#endif
+#ifdef USE_LTC6903
+volatile uint8_t ltc_pending;
+#endif
+#ifdef USE_DIP_SCAN
+uint8_t dip_state;
+#endif
+#if defined(USE_DIP_SCAN) || defined(USE_SYNC)
+uint16_t interval_offset;
+#endif
+#ifdef USE_SYNC
+uint8_t sync_lockout;
+#endif
+#ifdef USE_KEY_SHAPE
+uint8_t shape_key;
+const uint8_t* shape_ptr;
+int8_t shape_dir;
+volatile uint8_t shape_steps;
+#endif
+#ifdef USE_RESUME
+RESUME_STATE resume_state __attribute__((section(".noinit")));
+RESUME_STATE resume_ring[RESUME_SLOTS] EEMEM;
+uint8_t resume_slot;
+uint16_t resume_ticks;
+volatile uint8_t resume_pending;
+#endif
+#ifdef USE_CALIBRATE
+uint8_t cal_mode;
+int32_t cal_step;
+int32_t cal_acc;
+uint32_t cal_ticks;
+uint32_t cal_start;
+uint32_t cal_last;
+uint8_t cal_pulses;
+CAL_STATE cal_result;
+volatile uint8_t cal_pending;
+CAL_STATE cal_saved EEMEM;
+#endif
+#ifdef USE_SCHEDULE
+SCHED_WINDOW sched_table[SCHEDULE_COUNT] EEMEM = SCHEDULE_WINDOWS;
+SCHED_WINDOW sched_window;
+SCHED_WINDOW sched_ahead;
+volatile uint8_t sched_ahead_pending;
+#ifdef USE_SYNC
+SCHED_WINDOW sched_first;
+#endif
+uint32_t sched_ticks;
+uint32_t sched_next;
+uint8_t sched_index;
+volatile uint8_t sched_state;
+#endif
+#ifdef USE_BATTERY
+volatile uint8_t batt_pending;
+volatile uint8_t batt_low;
+uint16_t batt_adc;
+uint16_t batt_cycles;
+#endif
+#ifdef USE_TELEMETRY
+uint8_t tlm_ring[TLM_RING_SIZE];
+volatile uint8_t tlm_head;
+volatile uint8_t tlm_tail;
+uint8_t tlm_lost;
+uint16_t tlm_isr_max;
+#endif
+#ifdef USE_TRACE
+uint8_t trace_ring[TRACE_RING_SIZE];
+volatile uint8_t trace_head;
+volatile uint8_t trace_tail;
+uint8_t trace_lost;
+uint8_t trace_levels;
+uint16_t trace_ticks;
+TRACE_SUM trace_sum;
+uint8_t trace_partial;
+TRACE_SUM trace_ref;
+uint8_t trace_ref_valid;
+volatile uint8_t trace_pending;
+uint8_t trace_block;
+uint8_t trace_seq;
+uint8_t trace_used;
+uint8_t trace_run;
+TRACE_BLOCK trace_log[TRACE_BLOCKS] EEMEM;
+#endif
+#ifdef USE_TICKLESS
+uint16_t tickless_ocr;
+uint16_t tickless_frac;
+#endif
+#ifdef USE_POWER_DOWN
+uint8_t power_state;
+uint16_t power_ticks;
+uint32_t wdt_total;
+uint8_t wdt_timeouts;
+uint32_t wdt_period;
+uint32_t power_elapsed;
+uint32_t power_target;
+#endif
+
+/**** local functions ********************************************************/
+
+/*===========================================================================*/
+/*  Function: clock_set                                                      */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - div: clock division factor, as a power of 2                      */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    sets the system clock prescaler, the timed sequence needs the          */
+/*    interrupts to be disabled                                              */
+/*===========================================================================*/
+static inline void clock_set(uint8_t div)
+{
+  CLKPR = 1 << CLKPCE;
+  CLKPR = div;
+}
+
+
+/*===========================================================================*/
+/*  Function: clock_fast                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    runs the system clock undivided, for the work which needs it (SPI),    */
+/*    the prescaler of the tick timer is scaled with it, so the ticks stay   */
+/*    exact                                                                  */
+/*    interrupts must be disabled until clock_slow() is called               */
+/*===========================================================================*/
+static inline void clock_fast(void)
+{
+#if CLOCK_DIV_LOG2
+#ifdef USE_TICKLESS
+  TCCR1B = TICKLESS_CS_FAST;
+#else
+  TCCR0B = TIMER0_CS_FAST;
+#endif
+  clock_set(0);
+#endif
+}
+
+
+/*===========================================================================*/
+/*  Function: clock_slow                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    divides the system clock again, after clock_fast()                     */
+/*===========================================================================*/
+static inline void clock_slow(void)
+{
+#if CLOCK_DIV_LOG2
+  clock_set(CLOCK_DIV_LOG2);
+#ifdef USE_TICKLESS
+  TCCR1B = TICKLESS_CS;
+#else
+  TCCR0B = TIMER0_CS;
+#endif
+#endif
+}
+
+
+#ifdef USE_LTC6903
+/*===========================================================================*/
+/*  Function: ltc_write                                                      */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - word: LTC6903 control word                                       */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    programs the oscillator over the USI in three wire mode, the clock is  */
+/*    strobed by software in a loop, every edge takes 4 cycles, and the 16   */
+/*    bits about 140 cycles                                                  */
+/*    the SPI pins are outputs only for the transfer, then inputs with       */
+/*    pull-up as before, the KEY pin of the same port is not changed by any  */
+/*    of the instructions, and the port value of the next tick is updated    */
+/*    with the SPI pins, so the interrupt does not write back old levels     */
+/*    interrupts must be disabled                                            */
+/*===========================================================================*/
+static void ltc_write(uint16_t word)
+{
+  uint8_t strobe = (1 << USIWM0) | (1 << USICS1) | (1 << USICLK) | (1 << USITC);
+  uint8_t bytes;
+  uint8_t edges;
+
+  PRR &= ~(1 << PRUSI);
+  PORTB &= ~USI_SCK;
+  DDRB |= USI_DO | USI_SCK | OSC_SEN;
+  PORTB &= ~OSC_SEN;
+
+  // high byte (OCT3:0 DAC9:6), then low byte (DAC5:0 CNF1:0)
+  for (bytes = 2; bytes; bytes--)
+  {
+    USIDR = word >> 8;
+    word <<= 8;
+    for (edges = 16; edges; edges--)
+      USICR = strobe;
+  }
+
+  // disable USI, and set port to pullups where needed
+  USICR = 0;
+  PORTB |= OSC_SEN | USI_SCK | USI_DO;
+  DDRB &= ~(USI_DO | USI_SCK | OSC_SEN);
+  PRR |= (1 << PRUSI);
+  // clear pullup if USI_DO pin is pulled down
+  if (!(PINB & USI_DO))
+    PORTB &= ~USI_DO;
+
+  OUTPUT_NEXT = (OUTPUT_PORT & ~OUTPUT_MASK) | (OUTPUT_NEXT & OUTPUT_MASK);
+}
+#endif
+
+
+/*===========================================================================*/
+/*  Function: keying_tick                                                    */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    one tick of the keying, executed periodically at every 8ms             */
+/*                                                                           */
+/*    ATtiny261 does not have CTC functionality for 16bit mode, so only the  */
+/*    8 bit timer is used with CTC, so there is not enough resolution to     */
+/*    have a period equal to the morse code signs, these must be delayed     */
+/*    by software, counting enough periods for each element                  */
+/*    the elements are read from the precomputed keying schedule, which      */
+/*    holds the key level and the length in ticks of every element, so       */
+/*    only a single counter is decremented until the next element is due     */
+/*    the word length is a fraction of ticks for most speeds, the remainder  */
+/*    of the word space is accumulated, and a tick added when it is whole,   */
+/*    so the words do not drift                                              */
+/*    the periods are also counted for the interval timer, turning on/off    */
+/*    the whole transmitter                                                  */
+/*    the outputs are not written here, the port value is computed for the   */
+/*    next tick, the interrupt writes it before anything else                */
+/*    with a schedule the ticks are counted from the power-on, the keying    */
+/*    runs only in its windows                                               */
+/*===========================================================================*/
+static inline void keying_tick(void)
+{
+  uint8_t element;
+
+#ifdef USE_SCHEDULE
+  if (++sched_ticks == sched_next)
+    sched_event();
+  if (sched_state != SCHED_RUN)
+  {
+    output = 0;
+    OUTPUT(output ^ output_set);
+    return;
+  }
+#endif
+
+  // check if output is enabled
+  if (!interval || interval_ticks++ < enable_period)
+  {
+    // set output enable pin if necessary
+    output |= OUTPUT_ENABLE;
+#ifdef USE_TELEMETRY
+    if (interval && interval_ticks == 1)
+      tlm_event(TLM_WINDOW_START, NULL, 0);
+#endif
+
+    // step to the next element of the keying schedule when the current
+    // one has elapsed, the end of the word is followed by the word space
+    if (!--key_ticks)
+    {
+      element = pgm_read_byte(keying_ptr++);
+      if (element)
+      {
+        key_ticks = element & KEYING_TICKS;
+        if (element & KEYING_LEVEL)
+          output |= OUTPUT_KEY;
+        else
+          output &= ~OUTPUT_KEY;
+      }
+      else
+      {
+        key_ticks = space;
+        space_acc += space_rem;
+        if (space_acc >= space_mod)
+        {
+          space_acc -= space_mod;
+          key_ticks++;
+        }
+        keying_ptr = keying;
+        output &= ~OUTPUT_KEY;
+
+#ifdef USE_DIP_SCAN
+        // without windows the switches are sampled after every word
+        if (!interval)
+          dip_scan();
+#endif
+#ifdef USE_BATTERY
+        // and the battery is measured
+        if (!interval)
+          batt_pending = 1;
+#endif
+#ifdef USE_TELEMETRY
+        if (!interval)
+          tlm_isr_report();
+#endif
+      }
+    }
+
+    // in interval mode, key the transmitter for the last 2 seconds
+    if (interval && interval_ticks > enable_period - TXOFF_TICKS)
+    {
+#ifdef USE_BATTERY
+      // on a low battery the tone is shortened, the last word ends before
+      // it all the same, the key is released until the tone
+      if (batt_low && interval_ticks <= enable_period - BATT_TXOFF_TICKS)
+        output &= ~OUTPUT_KEY;
+      else
+#endif
+      output |= OUTPUT_KEY;
+    }
+
+#ifdef USE_LED
+    if (led_ticks >= LED_PERIOD)
+      led_ticks = 0;
+#endif
+  }
+  else
+  {
+    // restart the word at the beginning of the next enable period,
+    // after the lead-in that aligns the last word to the TXOFF tone
+    output &= ~(OUTPUT_ENABLE | OUTPUT_KEY);
+    keying_ptr = keying;
+    key_ticks = lead + 1;
+    space_acc = 0;
+
+    // the oscillator is programmed again at the start of the off-period,
+    // the switches are sampled and the battery is measured, the end of the
+    // window is reported
+    if (interval_ticks == enable_period + 1)
+    {
+#ifdef USE_TELEMETRY
+      tlm_event(TLM_WINDOW_STOP, NULL, 0);
+      tlm_isr_report();
+#endif
+#ifdef USE_BATTERY
+      batt_pending = 1;
+#endif
+#ifdef USE_LTC6903
+      ltc_pending = 1;
+#endif
+#ifdef USE_DIP_SCAN
+      dip_scan();
+#endif
+    }
+
+#ifdef USE_LED
+    if (led_ticks >= enable_period)
+      led_ticks = 0;
+#endif
+  }
+
+  // the interval is a full cycle of the fox set
+  if (interval_ticks == interval)
+    interval_ticks = 0;
+
+#ifdef USE_LED
+  if (led_ticks++ != 0)
+  {
+    output &= ~OUTPUT_LED;
+  }
+  else
+  {
+    output |= OUTPUT_LED;
+  }
+#endif
+
+  OUTPUT(output ^ output_set);
+}
+
+
+#ifdef USE_SCHEDULE
+/*===========================================================================*/
+/*  Function: sched_load                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    takes the next window of the schedule, read ahead by the main loop,    */
+/*    and waits for its start, the window after it is to be read ahead; the  */
+/*    interrupts do not read the EEPROM, so they do not wait for a write of  */
+/*    the main loop, nor change its address; after the last window the       */
+/*    schedule is turned off, the next event is never reached                */
+/*===========================================================================*/
+static void sched_load(void)
+{
+  if (sched_index == SCHEDULE_COUNT)
+  {
+    sched_state = SCHED_OFF;
+    sched_next = sched_ticks - 1;
+    return;
+  }
+
+  sched_window = sched_ahead;
+  sched_ahead_pending = 1;
+  sched_state = SCHED_WAIT;
+  sched_next = sched_window.start;
+}
+
+
+/*===========================================================================*/
+/*  Function: sched_event                                                    */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the start or end of a window is reached: at the end the next window is */
+/*    loaded and the oscillator turned off, at the start the settings of the */
+/*    window are read and the cycle of the set starts as after a reset, the  */
+/*    next window may start at the end of the previous one; the trace starts */
+/*    again from the start of a window                                       */
+/*===========================================================================*/
+static void sched_event(void)
+{
+  if (sched_state == SCHED_RUN)
+  {
+    sched_index++;
+    sched_load();
+#ifdef USE_LTC6903
+    frequency = LTC6903_OFF;
+    ltc_pending = 1;
+#endif
+    if (sched_state != SCHED_WAIT || sched_next != sched_ticks)
+      return;
+  }
+
+  sched_state = SCHED_RUN;
+  sched_next = sched_window.end;
+#ifdef USE_DIP_SCAN
+  // the switches are read with their pull-ups turned on for a moment
+  DIDR0 = 0x00;
+  PORTA = 0xFF;
+  _delay_loop_1(DIP_SETTLE_LOOPS);
+  dip_state = DIP_PINA;
+#endif
+  interval_ticks = dip_read();
+#if defined(USE_DIP_SCAN) || defined(USE_SYNC)
+  interval_offset = interval_ticks;
+#endif
+#ifdef USE_DIP_SCAN
+  DIDR0 = (uint8_t)~SYNC_PIN;
+  PORTA = SYNC_PIN;
+#endif
+  keying_ptr = keying;
+  key_ticks = lead + 1;
+  space_acc = 0;
+#ifdef USE_LTC6903
+  ltc_pending = 1;
+#endif
+#ifdef USE_TRACE
+  trace_start(TRACE_SCHED);
+#endif
+}
+
+
+/*===========================================================================*/
+/*  Function: sched_read_ahead                                               */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    reads the window after the current one from the EEPROM, for the        */
+/*    sched_load() at the end of the current one; a sync edge restarting     */
+/*    the schedule meanwhile asks for it again, so it is read again          */
+/*    called from the main loop, a window lasts for a second at least        */
+/*===========================================================================*/
+static void sched_read_ahead(void)
+{
+  SCHED_WINDOW window;
+  uint8_t index;
+
+  sched_ahead_pending = 0;
+  index = sched_index + 1;
+  if (index >= SCHEDULE_COUNT)
+    return;
+
+  eeprom_read_block(&window, &sched_table[index], sizeof(window));
+  cli();
+  if (!sched_ahead_pending)
+    sched_ahead = window;
+  sei();
+}
+#endif
+
+
+#ifdef USE_BATTERY
+/*===========================================================================*/
+/*  Function: batt_measure                                                   */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    measures the supply against the bandgap in the ADC noise reduction     */
+/*    sleep, the ADC is powered only for the two conversions                 */
+/*    the I/O clock is stopped in the sleep, so the Timer0 counts lost are   */
+/*    added back, the fraction of a count is carried to the next time, the   */
+/*    measurement waits for a tick where no compare match comes before the   */
+/*    correction, and no other interrupt can wake the MCU early: not in the  */
+/*    power-down and its watchdog measurement, nor in the calibration mode   */
+/*    the I/O clock of the Timer1 PWM is stopped too, so it waits for the    */
+/*    end of a key ramp                                                      */
+/*    called from the main loop                                              */
+/*===========================================================================*/
+static void batt_measure(void)
+{
+  uint8_t conversions;
+  uint16_t result;
+
+  if (TCNT0L >= TIMER0_TICK_COUNTS / 2)
+    return;
+#ifdef USE_LED_PULSE
+  if (TIMSK & (1 << OCIE0B))
+    return;
+#endif
+#ifdef USE_KEY_SHAPE
+  if (SHAPE_BUSY())
+    return;
+#endif
+#ifdef USE_POWER_DOWN
+  if (power_state != POWER_RUN)
+    return;
+#endif
+#ifdef USE_CALIBRATE
+  if (cal_mode)
+    return;
+#endif
+  batt_pending = 0;
+
+  // bandgap input, supply as reference, a conversion is started by every
+  // sleep, the first one after enabling is dropped
+  PRR &= ~(1 << PRADC);
+  ADMUX = 1 << MUX0;
+  ADCSRB = 1 << MUX5;
+  ADCSRA = (1 << ADEN) | (1 << ADIE) | BATT_ADPS;
+  set_sleep_mode(SLEEP_MODE_ADC);
+  sleep_enable();
+  for (conversions = 0; conversions < 2; conversions++)
+  {
+    do
+    {
+      sleep_cpu();
+    } while (ADCSRA & (1 << ADSC));
+  }
+  sleep_disable();
+  set_sleep_mode(SLEEP_MODE_IDLE);
+
+  cli();
+#ifdef USE_SYNC
+  // a sync edge in the sleep restarted Timer0, and selected the idle
+  // sleep, so the counts are not lost, the measurement is taken again
+  if (batt_pending)
+  {
+    sei();
+    ADCSRA = 0;
+    PRR |= 1 << PRADC;
+    return;
+  }
+#endif
+  batt_cycles += BATT_SLEEP_CYCLES;
+  TCNT0L += batt_cycles / TIMER0_PRESCALER;
+  batt_cycles %= TIMER0_PRESCALER;
+  sei();
+
+  result = ADCW;
+  ADCSRA = 0;
+  PRR |= 1 << PRADC;
+
+  // the result grows as the supply drops
+  batt_adc = result;
+  if (result > BATT_LOW_ADC)
+    batt_low = 1;
+  else if (result < BATT_OK_ADC)
+    batt_low = 0;
+}
+#endif
+
+#ifdef USE_TELEMETRY
+/*===========================================================================*/
+/*  Function: tlm_event                                                      */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - type: record type                                                */
+/*        - data: payload                                                    */
+/*        - size: payload size, up to 15 bytes                               */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    puts a record in the ring buffer, only the interrupts (and the         */
+/*    initialization before them) put records, the main loop takes them:     */
+/*    the bytes are written first, the head is moved after them, so the main */
+/*    loop never sees a record in part, and no lock is needed                */
+/*    a record which does not fit is dropped and counted, the count is put   */
+/*    before the next record which fits                                      */
+/*===========================================================================*/
+static void tlm_event(uint8_t type, const void *data, uint8_t size)
+{
+  const uint8_t *payload = data;
+  uint8_t head = tlm_head;
+  uint8_t room = (tlm_tail - head - 1) & (TLM_RING_SIZE - 1);
+
+  if (tlm_lost && room >= 2 + 1 + size)
+  {
+    tlm_ring[head] = TLM_HEADER(TLM_LOST, 1);
+    head = (head + 1) & (TLM_RING_SIZE - 1);
+    tlm_ring[head] = tlm_lost;
+    head = (head + 1) & (TLM_RING_SIZE - 1);
+    room -= 2;
+    tlm_lost = 0;
+  }
+  if (room < 1 + size)
+  {
+    if (tlm_lost != 0xFF)
+      tlm_lost++;
+    return;
+  }
+
+  tlm_ring[head] = TLM_HEADER(type, size);
+  head = (head + 1) & (TLM_RING_SIZE - 1);
+  while (size--)
+  {
+    tlm_ring[head] = *payload++;
+    head = (head + 1) & (TLM_RING_SIZE - 1);
+  }
+  tlm_head = head;
+}
+
+
+/*===========================================================================*/
+/*  Function: tlm_isr_report                                                 */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    puts the longest tick interrupt since the last report in the buffer,   */
+/*    and starts a new measurement                                           */
+/*===========================================================================*/
+static void tlm_isr_report(void)
+{
+  tlm_event(TLM_ISR, &tlm_isr_max, sizeof(tlm_isr_max));
+  tlm_isr_max = 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: tlm_cycles                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - Timer1 count, in CPU cycles                                      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    reads the 10 bit counter, the read of the low byte latches the high    */
+/*    bits in TC1H                                                           */
+/*===========================================================================*/
+static inline uint16_t tlm_cycles(void)
+{
+  uint8_t low = TCNT1;
+
+  return ((uint16_t)TC1H << 8) | low;
+}
+
+
+/*===========================================================================*/
+/*  Function: tlm_send                                                       */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - byte: byte to send                                               */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    sends a byte in an 8N1 frame on the USI DO pin: in three wire mode     */
+/*    with no clock source the pin follows the MSB of USIDR at once, so      */
+/*    every bit is a write of USIDR and the delay of the bit                 */
+/*    the pin is driven only for the frame, then it is left on its pull-up,  */
+/*    the idle level of the line                                             */
+/*    called at the undivided clock, with the interrupts disabled            */
+/*===========================================================================*/
+static void tlm_send(uint8_t byte)
+{
+  // start bit, 8 data bits from the LSB, stop bit
+  uint16_t frame = ((uint16_t)byte << 1) | 0x200;
+  uint8_t bits;
+
+  PRR &= ~(1 << PRUSI);
+  USIDR = 0xFF;
+  USICR = 1 << USIWM0;
+  DDRB |= TLM_TX;
+  for (bits = 0; bits < 10; bits++)
+  {
+    USIDR = -(uint8_t)(frame & 1);
+    frame >>= 1;
+    _delay_loop_1(TLM_BIT_LOOPS);
+  }
+  USICR = 0;
+  DDRB &= ~TLM_TX;
+  PRR |= 1 << PRUSI;
+}
+
+
+/*===========================================================================*/
+/*  Function: tlm_drain                                                      */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    sends the records of the ring buffer from the main loop, a byte at a   */
+/*    time, at the undivided clock with the interrupts disabled, only if it  */
+/*    ends before the next tick, the rest is sent after the tick, so no      */
+/*    interrupt waits for the UART                                           */
+/*    nothing is sent in the LED pulse, the power-down and the watchdog      */
+/*    measurement after its first tick, nor in the calibration mode, where   */
+/*    an interrupt delayed would be timed wrong, with the switch of the pin  */
+/*    closed the records are dropped                                         */
+/*===========================================================================*/
+static void tlm_drain(void)
+{
+  uint8_t tail = tlm_tail;
+
+#ifdef USE_LED_PULSE
+  if (TIMSK & (1 << OCIE0B))
+    return;
+#endif
+#ifdef USE_POWER_DOWN
+  // the watchdog measurement times out first a second after its start
+  if (power_state != POWER_RUN && (power_state != POWER_CAL || power_ticks))
+    return;
+#endif
+#ifdef USE_CALIBRATE
+  if (cal_mode)
+    return;
+#endif
+  if (!(PINB & TLM_TX))
+  {
+    tlm_tail = tlm_head;
+    return;
+  }
+
+  while (tail != tlm_head && TCNT0L < TLM_SEND_COUNTS)
+  {
+    cli();
+    clock_fast();
+    tlm_send(tlm_ring[tail]);
+    clock_slow();
+    sei();
+    tail = (tail + 1) & (TLM_RING_SIZE - 1);
+    tlm_tail = tail;
+  }
+}
+#endif
+
+#ifdef USE_TRACE
+/*===========================================================================*/
+/*  Function: trace_event                                                    */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - record: first byte of the record                                 */
+/*        - data: rest of the record                                         */
+/*        - size: bytes of the rest                                          */
+/*  Return value:                                                            */
+/*        - 1 if the record was put in the buffer, 0 if it was dropped       */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    puts a record in the ring buffer, as tlm_event(): only the interrupts  */
+/*    (and the initialization before them) put records, the head is moved    */
+/*    after the bytes, the main loop takes whole records                     */
+/*    a record which does not fit is dropped, a TRACE_LOST record is put     */
+/*    before the next one which fits, and the next window is written whole   */
+/*===========================================================================*/
+static uint8_t trace_event(uint8_t record, const void *data, uint8_t size)
+{
+  const uint8_t *rest = data;
+  uint8_t head = trace_head;
+  uint8_t room = (trace_tail - head - 1) & (TRACE_RING_SIZE - 1);
+
+  if (room < trace_lost + 1 + size)
+  {
+    trace_lost = 1;
+    trace_ref_valid = 0;
+    return 0;
+  }
+  if (trace_lost)
+  {
+    trace_ring[head] = TRACE_LOST;
+    head = (head + 1) & (TRACE_RING_SIZE - 1);
+    trace_lost = 0;
+  }
+
+  trace_ring[head] = record;
+  head = (head + 1) & (TRACE_RING_SIZE - 1);
+  while (size--)
+  {
+    trace_ring[head] = *rest++;
+    head = (head + 1) & (TRACE_RING_SIZE - 1);
+  }
+  trace_head = head;
+
+  return 1;
+}
+
+
+/*===========================================================================*/
+/*  Function: trace_edge                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - levels: TRACE_OPEN and TRACE_KEYED levels of the tick            */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    sums up the window at a change of the levels: its start, a window open */
+/*    at the first tick of the trace is partial unless the interval cycle    */
+/*    starts with the tick; its key edges, the signature is rotated and the  */
+/*    tick of the edge from the start added; at its end the sum is written,  */
+/*    or only counted in a run if it is the same as the reference, the last  */
+/*    whole window written, and starts an interval after the window before   */
+/*===========================================================================*/
+static void trace_edge(uint8_t levels)
+{
+  TRACE_SUM *sum = &trace_sum;
+  uint8_t one = 1;
+
+  if (levels & ~trace_levels & TRACE_OPEN)
+  {
+    trace_partial = (trace_levels & TRACE_FIRST) && interval_ticks != 1;
+    sum->start = trace_ticks;
+    sum->edges = 0;
+    sum->signature = 0;
+    trace_ticks = 0;
+  }
+
+  if (levels & TRACE_OPEN)
+  {
+    if ((levels ^ trace_levels) & TRACE_KEYED)
+    {
+      sum->edges++;
+      sum->signature = (uint16_t)(sum->signature << 1 | sum->signature >> 15) ^ trace_ticks;
+    }
+  }
+  else if (trace_levels & TRACE_OPEN)
+  {
+    sum->length = trace_ticks;
+    if (trace_partial)
+    {
+      trace_event(TRACE_PARTIAL, sum, sizeof(*sum));
+    }
+    else if (trace_ref_valid && sum->start == interval &&
+             sum->length == trace_ref.length && sum->edges == trace_ref.edges &&
+             sum->signature == trace_ref.signature)
+    {
+      trace_event(TRACE_RUN, &one, sizeof(one));
+    }
+    else
+    {
+      trace_ref = *sum;
+      trace_ref_valid = trace_event(TRACE_WINDOW, sum, sizeof(*sum));
+    }
+  }
+
+  trace_levels = levels;
+}
+
+
+/*===========================================================================*/
+/*  Function: trace_tick                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    called after every keying tick, with the outputs computed for the next */
+/*    tick: a change of the window or of the key in it is summed up, the     */
+/*    ticks are counted up to TRACE_MAX_TICKS; the records are written to    */
+/*    the EEPROM log in the off-period, in continuous keying at once, as     */
+/*    there are only the start and the settings                              */
+/*===========================================================================*/
+static inline void trace_tick(void)
+{
+  uint8_t levels = 0;
+
+  if (TRACE_IN_WINDOW())
+    levels |= TRACE_OPEN;
+  if (output & OUTPUT_KEY)
+    levels |= TRACE_KEYED;
+
+  if (levels != trace_levels)
+    trace_edge(levels);
+  if (trace_ticks != TRACE_MAX_TICKS)
+    trace_ticks++;
+  if (trace_head != trace_tail && (!(levels & TRACE_OPEN) || !interval))
+    trace_pending = 1;
+}
+
+
+#ifdef USE_POWER_DOWN
+/*===========================================================================*/
+/*  Function: trace_skip                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - ticks: ticks skipped in the power-down                           */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    counts the ticks skipped, the outputs do not change in them            */
+/*===========================================================================*/
+static void trace_skip(uint16_t ticks)
+{
+  if (ticks < TRACE_MAX_TICKS - trace_ticks)
+    trace_ticks += ticks;
+  else
+    trace_ticks = TRACE_MAX_TICKS;
+}
+#endif
+
+
+#ifdef USE_SYNC
+/*===========================================================================*/
+/*  Function: trace_phase                                                    */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - ticks: interval counter at the sync edge                         */
+/*        - count: Timer0 count at the edge, or TRACE_PHASE_UNKNOWN          */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    puts the phase of the fox at a sync edge, before the cycle is started  */
+/*    again from it: against the interval counter it is set to, the drift of */
+/*    the fox from the reference of the sync pulses, if they come at whole   */
+/*    cycles of the set                                                      */
+/*===========================================================================*/
+static void trace_phase(uint16_t ticks, uint8_t count)
+{
+  uint8_t data[3];
+
+  data[0] = (uint8_t)ticks;
+  data[1] = ticks >> 8;
+  data[2] = count;
+  trace_event(TRACE_PHASE, data, sizeof(data));
+}
+#endif
+
+
+/*===========================================================================*/
+/*  Function: trace_start                                                    */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - flags: reset flags of MCUSR, or TRACE_SYNC                       */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    puts the start record, with the interval counter before the first      */
+/*    tick, the trace_tick() after the first keying tick counts from it; the */
+/*    window open then is partial, and the next one is written whole         */
+/*===========================================================================*/
+static void trace_start(uint8_t flags)
+{
+  uint8_t data[3];
+
+  data[0] = flags;
+  data[1] = (uint8_t)interval_ticks;
+  data[2] = interval_ticks >> 8;
+  trace_event(TRACE_START, data, sizeof(data));
+
+  trace_levels = TRACE_FIRST;
+  trace_ticks = 0;
+  trace_ref_valid = 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: trace_init                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    finds the newest block of the EEPROM log, the one with the largest     */
+/*    number, the numbers of the ring are within TRACE_BLOCKS of each other, */
+/*    a block of an erased EEPROM is not valid; the records of this run      */
+/*    start in the block after it                                            */
+/*===========================================================================*/
+static void trace_init(void)
+{
+  uint8_t found = 0;
+  uint8_t block;
+  uint8_t seq;
+
+  trace_block = TRACE_BLOCKS - 1;
+  for (block = 0; block < TRACE_BLOCKS; block++)
+  {
+    if (eeprom_read_byte(&trace_log[block].used) > TRACE_BLOCK_DATA)
+      continue;
+    seq = eeprom_read_byte(&trace_log[block].seq);
+    if (!found || (int8_t)(seq - trace_seq) > 0)
+    {
+      trace_seq = seq;
+      trace_block = block;
+      found = 1;
+    }
+  }
+  trace_used = TRACE_BLOCK_DATA;
+}
+
+
+/*===========================================================================*/
+/*  Function: trace_flush                                                    */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    writes the records of the ring buffer to the EEPROM log, a record      */
+/*    which does not fit in the current block goes to the next one, which    */
+/*    is emptied and numbered first, the bytes used are written at the end,  */
+/*    so a reset in the middle leaves a valid block                          */
+/*    a run right after the run record written last is counted in it, up to  */
+/*    TRACE_RUN_MAX, so a window the same as the one before writes a single  */
+/*    byte; every other byte is written once in a pass of the ring           */
+/*    called from the main loop, the bytes are written in 3.4ms each, the    */
+/*    interrupts keep running meanwhile                                      */
+/*===========================================================================*/
+static void trace_flush(void)
+{
+  TRACE_BLOCK *block = &trace_log[trace_block];
+  uint8_t tail = trace_tail;
+  uint8_t written = 0;
+  uint8_t record;
+  uint8_t size;
+  uint8_t count;
+
+  trace_pending = 0;
+  while (tail != trace_head)
+  {
+    record = trace_ring[tail];
+    size = TRACE_SIZE(record);
+    if (record == TRACE_RUN && trace_run)
+    {
+      count = eeprom_read_byte(&block->data[trace_run]);
+      if (count < TRACE_RUN_MAX)
+      {
+        eeprom_update_byte(&block->data[trace_run], count + 1);
+        tail = (tail + size) & (TRACE_RING_SIZE - 1);
+        trace_tail = tail;
+        continue;
+      }
+    }
+    if (trace_used + size > TRACE_BLOCK_DATA)
+    {
+      if (written)
+        eeprom_update_byte(&block->used, trace_used);
+      if (++trace_block == TRACE_BLOCKS)
+        trace_block = 0;
+      block = &trace_log[trace_block];
+      eeprom_update_byte(&block->used, 0);
+      eeprom_update_byte(&block->seq, ++trace_seq);
+      trace_used = 0;
+    }
+    trace_run = record == TRACE_RUN ? trace_used + 1 : 0;
+    while (size--)
+    {
+      eeprom_update_byte(&block->data[trace_used++], trace_ring[tail]);
+      tail = (tail + 1) & (TRACE_RING_SIZE - 1);
+    }
+    trace_tail = tail;
+    written = 1;
+  }
+  if (written)
+    eeprom_update_byte(&block->used, trace_used);
+}
+#endif
+
+#if defined(USE_RESUME) || defined(USE_CALIBRATE)
+/*===========================================================================*/
+/*  Function: crc8                                                           */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - data: saved state                                                */
+/*        - size: bytes before its CRC field                                 */
+/*  Return value:                                                            */
+/*        - CRC-8 of the state                                               */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    computes the CRC-8 of the fields before the CRC, a state torn by a     */
+/*    reset in the middle of a write, or RAM lost by a power cut, does not   */
+/*    match it                                                               */
+/*===========================================================================*/
+static uint8_t crc8(const void *data, uint8_t size)
+{
+  const uint8_t *byte = (const uint8_t *)data;
+  uint8_t crc = CRC8_INIT;
+
+  while (size--)
+    crc = _crc8_ccitt_update(crc, *byte++);
+
+  return crc;
+}
+#endif
+
+
+#ifdef USE_RESUME
+
+/*===========================================================================*/
+/*  Function: resume_tick                                                    */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - ticks: interval counter at this time                             */
+/*        - elapsed: ticks since the last call                               */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    called from the interrupts, keeps the interval counter in the RAM      */
+/*    copy, and asks the main loop to save it to the EEPROM ring after every */
+/*    RESUME_SAVE_TICKS                                                      */
+/*    in continuous mode there is no cycle to resume                         */
+/*===========================================================================*/
+static inline void resume_tick(uint16_t ticks, uint8_t elapsed)
+{
+  if (!interval)
+    return;
+
+  resume_state.interval_ticks = ticks;
+  resume_state.crc = crc8(&resume_state, offsetof(RESUME_STATE, crc));
+
+  resume_ticks += elapsed;
+  if (resume_ticks >= RESUME_SAVE_TICKS)
+  {
+    resume_ticks -= RESUME_SAVE_TICKS;
+    resume_pending = 1;
+  }
+}
+
+
+/*===========================================================================*/
+/*  Function: resume_save                                                    */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    writes the RAM copy of the state to the next slot of the EEPROM ring,  */
+/*    with the next save number                                              */
+/*    called from the main loop, the bytes are written in 3.4ms each, the    */
+/*    interrupts keep running meanwhile                                      */
+/*===========================================================================*/
+static void resume_save(void)
+{
+  RESUME_STATE state;
+
+  cli();
+  resume_state.seq++;
+  resume_state.crc = crc8(&resume_state, offsetof(RESUME_STATE, crc));
+  state = resume_state;
+  resume_pending = 0;
+  sei();
+
+  eeprom_update_block(&state, &resume_ring[resume_slot], sizeof(state));
+  if (++resume_slot == RESUME_SLOTS)
+    resume_slot = 0;
+}
+#endif
+
+
+
+#if defined(USE_TICKLESS) || defined(USE_POWER_DOWN)
+/*===========================================================================*/
+/*  Function: keying_next_event                                              */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - limit: largest number of ticks returned                          */
+/*  Return value:                                                            */
+/*        - number of ticks until the next tick changing an output           */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the outputs change only when a keying element is due, at the start     */
+/*    of the TXOFF tone, at the start and end of the enable period and of    */
+/*    the windows of the schedule, and when the LED is turned on or off, the */
+/*    nearest of these is returned, limited to the longest time the caller   */
+/*    can sleep                                                              */
+/*===========================================================================*/
+static uint16_t keying_next_event(uint16_t limit)
+{
+  uint16_t next;
+  uint8_t keyed = 1;
+#ifdef USE_LED
+  uint16_t led_period = LED_PERIOD;
+#endif
+
+#ifdef USE_SCHEDULE
+  // the start or end of a window, out of the windows nothing else
+  if (sched_next - sched_ticks < limit)
+    limit = sched_next - sched_ticks;
+  if (sched_state != SCHED_RUN)
+    return limit;
+#endif
+  next = limit;
+
+  if (interval)
+  {
+    // enable window: start of TXOFF, end of enable period, next cycle
+    if (!interval_ticks)
+      next = 1;
+    else if (interval_ticks <= enable_period - TXOFF_TICKS)
+      next = enable_period - TXOFF_TICKS - interval_ticks + 1;
+#ifdef USE_BATTERY
+    else if (batt_low && interval_ticks <= enable_period - BATT_TXOFF_TICKS)
+      next = enable_period - BATT_TXOFF_TICKS - interval_ticks + 1;
+#endif
+    else if (interval_ticks <= enable_period)
+      next = enable_period - interval_ticks + 1;
+    else
+      next = interval - interval_ticks + 1;
+
+    // the keying is hidden by the tone and restarted after it
+    keyed = interval_ticks < enable_period - TXOFF_TICKS;
+#ifdef USE_LED
+    if (interval_ticks >= enable_period)
+      led_period = enable_period;
+#endif
+  }
+
+  if (keyed && key_ticks < next)
+    next = key_ticks;
+
+#ifdef USE_LED
+  // the LED is on for a single tick at the start of its period
+  if (led_ticks <= 1 || led_ticks >= led_period)
+    next = 1;
+  else if (led_period - led_ticks + 1 < next)
+    next = led_period - led_ticks + 1;
+#endif
+
+  return next < limit ? next : limit;
+}
+
+
+/*===========================================================================*/
+/*  Function: keying_skip                                                    */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - ticks: number of ticks skipped                                   */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    advances the counters over ticks which do not change any output, the   */
+/*    same way the keying_tick() would do for every one of them              */
+/*===========================================================================*/
+static void keying_skip(uint16_t ticks)
+{
+#ifdef USE_SCHEDULE
+  // out of the windows the keying stands still
+  sched_ticks += ticks;
+  if (sched_state != SCHED_RUN)
+    return;
+#endif
+
+  if (!interval || interval_ticks < enable_period - TXOFF_TICKS)
+    key_ticks -= ticks;
+
+  if (interval)
+  {
+    interval_ticks += ticks;
+    if (interval_ticks == interval)
+      interval_ticks = 0;
+  }
+
+#ifdef USE_LED
+  led_ticks += ticks;
+#endif
+}
+#endif
+
+
+#ifdef USE_TICKLESS
+/*===========================================================================*/
+/*  Function: TIMER1_COMPA                                                   */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    Interrupt service routine for Timer1 Compare A module                  */
+/*    interrupt is executed only at the ticks changing an output             */
+/*                                                                           */
+/*    Timer1 runs free with 10 bit period, the compare value is moved        */
+/*    forward for the next output change, the ticks in between are           */
+/*    skipped, so the MCU sleeps most of the time even during keying         */
+/*    the tick is not a whole count, its fraction is accumulated in          */
+/*    1/8 counts, so the ticks do not drift, only the edges are rounded      */
+/*    to the nearest count (0.5ms)                                           */
+/*    the outputs of this tick were computed by the previous interrupt, they */
+/*    are written first, then the keying is advanced to the next event       */
+/*===========================================================================*/
+ISR(TIMER1_COMPA_vect)
+{
+  uint8_t ticks;
+#ifdef USE_RESUME
+  uint8_t back;
+#endif
+
+  OUTPUT_WRITE();
+
+  ticks = keying_next_event(TICKLESS_MAX_TICKS);
+  keying_skip(ticks - 1);
+  keying_tick();
+#ifdef USE_RESUME
+  // the counters are of the next event, a reset comes halfway to it on
+  // average, the state saved is of that tick
+  back = (ticks - 1) / 2;
+  resume_tick(interval_ticks >= back ? interval_ticks - back : interval_ticks + interval - back, ticks);
+#endif
+
+  tickless_frac += (uint16_t)TICKLESS_COUNTS_X8 * ticks;
+  tickless_ocr = (tickless_ocr + (tickless_frac >> 3)) & TICKLESS_TOP;
+  tickless_frac &= 7;
+
+  TC1H = tickless_ocr >> 8;
+  OCR1A = tickless_ocr & 0xFF;
+}
+
+#else
+#ifdef USE_POWER_DOWN
+/*===========================================================================*/
+/*  Function: wdt_start                                                      */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    starts the watchdog in interrupt mode, its period counts from here     */
+/*===========================================================================*/
+static void wdt_start(void)
+{
+  wdt_reset();
+  WDTCR = (1 << WDCE) | (1 << WDE);
+  WDTCR = (1 << WDIE) | POWER_DOWN_WDP;
+}
+
+
+/*===========================================================================*/
+/*  Function: wdt_stop                                                       */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    turns off the watchdog, with the timed sequence needed to clear WDE    */
+/*===========================================================================*/
+static void wdt_stop(void)
+{
+  WDTCR = (1 << WDCE) | (1 << WDE);
+  WDTCR = 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: power_resume                                                   */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - elapsed: time since the last tick, in 1/128 Timer0 counts        */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    stops the watchdog and continues on Timer0: the ticks elapsed are      */
+/*    skipped and the counter is set to the fraction of the current tick, so */
+/*    the phase of the interval cycle is kept                                */
+/*===========================================================================*/
+static void power_resume(uint32_t elapsed)
+{
+  wdt_stop();
+
+  keying_skip(elapsed / POWER_TICK_UNITS);
+#ifdef USE_TRACE
+  trace_skip(elapsed / POWER_TICK_UNITS);
+#endif
+  TCNT0L = (elapsed % POWER_TICK_UNITS + POWER_COUNT_UNITS / 2) / POWER_COUNT_UNITS;
+  TIFR = 1 << OCF0A;
+  TIMSK = 1 << OCIE0A;
+
+  power_state = POWER_RUN;
+}
+
+
+/*===========================================================================*/
+/*  Function: power_tick                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    called at every tick, measures the watchdog period and powers down     */
+/*    in the off-period                                                      */
+/*                                                                           */
+/*    the watchdog oscillator varies with the supply voltage and             */
+/*    temperature, so its period is measured over the whole enable           */
+/*    period, right before it is used, the MCU is running then anyway        */
+/*    in the off-period the MCU is powered down until the next output        */
+/*    change, if at least one watchdog period fits before it                 */
+/*===========================================================================*/
+static inline void power_tick(void)
+{
+  uint16_t ticks;
+  uint8_t measure;
+  uint8_t window;
+
+#ifdef USE_SCHEDULE
+  // waiting for a window of the schedule the watchdog is measured before
+  // every power-down, its period drifts over the hours of the wait
+  if (sched_state != SCHED_RUN)
+  {
+    measure = power_state == POWER_RUN;
+    window = 0;
+  }
+  else
+#endif
+  {
+    if (!interval)
+      return;
+    measure = interval_ticks == 1;
+    window = interval_ticks <= enable_period;
+  }
+
+  // start measuring at the start of the enable period, or right away
+  // if the controller is started in the off-period
+  if (measure || (!wdt_period && power_state == POWER_RUN))
+  {
+    wdt_start();
+    power_ticks = 0;
+    wdt_timeouts = 0;
+    power_state = POWER_CAL;
+    return;
+  }
+
+  if (power_state == POWER_CAL)
+  {
+    power_ticks++;
+    if (window || !wdt_timeouts)
+      return;
+
+    wdt_stop();
+    wdt_period = wdt_total / wdt_timeouts;
+    power_state = POWER_RUN;
+  }
+
+  // the outputs of the next tick shall be written before powering down
+  if (window || OUTPUT_NEXT != OUTPUT_PORT)
+    return;
+#ifdef USE_KEY_SHAPE
+  // and the key ramp ended, Timer1 stops in power-down
+  if (SHAPE_BUSY())
+    return;
+#endif
+
+  ticks = keying_next_event(0xFFFF);
+  power_target = (uint32_t)ticks * POWER_TICK_UNITS;
+  if (wdt_period + POWER_DOWN_STARTUP +
+      POWER_DOWN_MARGIN_TICKS * POWER_TICK_UNITS > power_target)
+    return;
+
+  // Timer0 stops in power-down, the main loop selects the sleep mode
+  wdt_start();
+  power_elapsed = 0;
+  TIMSK = 0;
+  power_state = POWER_DOWN;
+}
+
+
+/*===========================================================================*/
+/*  Function: WDT                                                            */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    Interrupt service routine for the watchdog time-out                    */
+/*                                                                           */
+/*    while measuring, the time since the start is read from Timer0, a       */
+/*    compare match not yet serviced is counted too                          */
+/*    when powered down, the watchdog period is added to the time slept and  */
+/*    Timer0 is restarted before the next output change, adding the          */
+/*    oscillator start-up time                                               */
+/*===========================================================================*/
+ISR(WDT_vect)
+{
+  uint8_t count;
+  uint32_t elapsed;
+
+  if (power_state == POWER_CAL)
+  {
+    // the time-out is within the count read, take its middle
+    count = TCNT0L;
+    elapsed = (uint16_t)count * POWER_COUNT_UNITS + POWER_COUNT_UNITS / 2;
+    if ((TIFR & (1 << OCF0A)) && count < TIMER0_TICK_COUNTS / 2)
+      elapsed += POWER_TICK_UNITS;
+    wdt_total = (uint32_t)power_ticks * POWER_TICK_UNITS + elapsed;
+    wdt_timeouts++;
+  }
+  else if (power_state == POWER_DOWN)
+  {
+    power_elapsed += wdt_period;
+#ifdef USE_RESUME
+    // the ticks slept are counted for the saved state too, a reset comes
+    // halfway to the next time-out on average
+    resume_tick(interval_ticks + (power_elapsed + wdt_period / 2) / POWER_TICK_UNITS,
+                TICKS_PER_SECOND);
+#endif
+    if (power_elapsed + wdt_period + POWER_DOWN_STARTUP +
+        POWER_DOWN_MARGIN_TICKS * POWER_TICK_UNITS > power_target)
+    {
+      power_resume(power_elapsed + POWER_DOWN_STARTUP);
+    }
+  }
+}
+#endif
+
+
+/*===========================================================================*/
+/*  Function: TIMER0_COMPA                                                   */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    Interrupt service routine for Timer0 Compare A module                  */
+/*    interrupt is executed periodically at every 8ms                        */
+/*                                                                           */
+/*    the outputs of this tick were computed at the previous one, they are   */
+/*    written first, so the edges follow the timer event by the fixed        */
+/*    prologue, whatever path the keying takes, then the keying is advanced  */
+/*    to the next tick                                                       */
+/*===========================================================================*/
+ISR(TIMER0_COMPA_vect)
+{
+#ifdef USE_TELEMETRY
+  uint16_t cycles;
+#endif
+
+  OUTPUT_WRITE();
+#ifdef USE_TELEMETRY
+  cycles = tlm_cycles();
+#endif
+#ifdef USE_LED_PULSE
+  // the LED turned on is turned off by the compare match B of this tick,
+  // its flag was set by the previous tick
+  if (OUTPUT_PORT & OUTPUT_LED)
+  {
+    TIFR = 1 << OCF0B;
+    TIMSK |= 1 << OCIE0B;
+  }
+#endif
+#ifdef USE_CALIBRATE
+  // the ticks are timing the reference pulses, with no keying
+  if (cal_mode)
+  {
+    cal_ticks++;
+    return;
+  }
+
+  // some ticks are a count longer or shorter, so the average tick follows
+  // the reference, the compare value is written at the start of the tick
+  cal_acc += cal_step;
+  OCR0A = TIMER0_TICK_COUNTS - 1 + (int8_t)(cal_acc >> 16);
+  cal_acc &= 0xFFFF;
+#endif
+#ifdef USE_KEY_SHAPE
+  shape_edge();
+#endif
+  keying_tick();
+#ifdef USE_TRACE
+  trace_tick();
+#endif
+#ifdef USE_SYNC
+  // the sync input is enabled again a while after its edge
+  if (sync_lockout && !--sync_lockout)
+    PCMSK0 |= SYNC_PIN;
+#endif
+#ifdef USE_RESUME
+  resume_tick(interval_ticks, 1);
+#endif
+#ifdef USE_POWER_DOWN
+  power_tick();
+#endif
+#ifdef USE_TELEMETRY
+  cycles = (tlm_cycles() - cycles) & TLM_CYCLE_TOP;
+  if (cycles > tlm_isr_max)
+    tlm_isr_max = cycles;
+#endif
+}
+#endif
+
+
+#ifdef USE_LED_PULSE
+/*===========================================================================*/
+/*  Function: TIMER0_COMPB                                                   */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    Interrupt service routine for Timer0 Compare B module                  */
+/*    interrupt is enabled only in the ticks turning the LED on              */
+/*                                                                           */
+/*    the LED is turned off LED_PULSE_US after the tick, the next tick       */
+/*    writes it off too                                                      */
+/*===========================================================================*/
+ISR(TIMER0_COMPB_vect)
+{
+  OUTPUT_PORT &= ~OUTPUT_LED;
+  TIMSK &= ~(1 << OCIE0B);
+}
+#endif
+
+
+#ifdef USE_KEY_SHAPE
+/*===========================================================================*/
+/*  Function: shape_edge                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    starts a key ramp when the key bit of the port changed, called right   */
+/*    after the port is written: the key pin is driven by the OC1B output,   */
+/*    the port bit only tells the level the ramp goes to, so the pin does    */
+/*    not follow it for the cycles until the ramp starts                     */
+/*    the first level is written at once, Timer1 is started from BOTTOM,     */
+/*    and its overflow steps the ramp                                        */
+/*===========================================================================*/
+static inline void shape_edge(void)
+{
+  uint8_t key = OUTPUT_PORT & OUTPUT_KEY;
+
+  if (key == shape_key)
+    return;
+  shape_key = key;
+
+  if (key)
+  {
+    shape_ptr = shape_levels + 1;
+    shape_dir = 1;
+  }
+  else
+  {
+    shape_ptr = shape_levels + KEY_SHAPE_STEPS - 1;
+    shape_dir = -1;
+  }
+  OCR1B = pgm_read_byte(shape_ptr);
+  shape_ptr += shape_dir;
+  shape_steps = KEY_SHAPE_STEPS;
+
+  TCNT1 = 0;
+  TIFR = 1 << TOV1;
+  TIMSK |= 1 << TOIE1;
+  TCCR1B = KEY_SHAPE_CS;
+}
+
+
+/*===========================================================================*/
+/*  Function: TIMER1_OVF                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    Interrupt service routine for Timer1 Overflow                          */
+/*    interrupt is executed at the BOTTOM of every PWM period of a ramp      */
+/*                                                                           */
+/*    the next level is written, it is latched at the next BOTTOM, a period  */
+/*    after the last level the timer is stopped, OC1B keeps the level until  */
+/*    the next ramp                                                          */
+/*===========================================================================*/
+ISR(TIMER1_OVF_vect)
+{
+  if (--shape_steps)
+  {
+    OCR1B = pgm_read_byte(shape_ptr);
+    shape_ptr += shape_dir;
+  }
+  else
+  {
+    TCCR1B = 0;
+  }
+}
+#endif
+
+
+#ifdef USE_BATTERY
+/*===========================================================================*/
+/*  Function: ADC                                                            */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    Interrupt service routine for the ADC conversion complete              */
+/*    only wakes the MCU from the ADC noise reduction sleep                  */
+/*===========================================================================*/
+EMPTY_INTERRUPT(ADC_vect);
+#endif
+
+
+#ifdef USE_CALIBRATE
+/*===========================================================================*/
+/*  Function: cal_pulse                                                      */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    pin change of the reference input, called by the interrupt in the      */
+/*    calibration mode                                                       */
+/*                                                                           */
+/*    the rising edges are timed in Timer0 counts, the ticks counted and     */
+/*    the counter read, a compare match not yet serviced is counted too      */
+/*    the counts of CAL_PULSES seconds are compared to the nominal ones, a   */
+/*    pulse further from a second of the one before starts the measurement   */
+/*    again, the measurements follow each other, every one is saved          */
+/*    the key output follows the reference, the enable output is turned on   */
+/*    at the first result                                                    */
+/*===========================================================================*/
+static inline void cal_pulse(void)
+{
+  uint8_t count;
+  uint32_t time;
+  int32_t error;
+
+  count = TCNT0L;
+  time = cal_ticks;
+  if ((TIFR & (1 << OCF0A)) && count < TIMER0_TICK_COUNTS / 2)
+    time++;
+  time = time * TIMER0_TICK_COUNTS + count;
+
+  if (!(PINA & CAL_PIN))
+  {
+    output &= ~OUTPUT_KEY;
+    OUTPUT(output ^ output_set);
+    return;
+  }
+  output |= OUTPUT_KEY;
+
+  if (cal_pulses &&
+      time - cal_last + CAL_MAX_COUNTS - CAL_SECOND_COUNTS > 2 * CAL_MAX_COUNTS)
+    cal_pulses = 0;
+  cal_last = time;
+
+  if (!cal_pulses++)
+  {
+    cal_start = time;
+  }
+  else if (cal_pulses > CAL_PULSES)
+  {
+    error = (int32_t)(time - cal_start - CAL_COUNTS);
+    cal_result.error = (int16_t)error;
+    cal_result.step = error * 65536 / (CAL_PULSES * TICKS_PER_SECOND);
+    cal_pending = 1;
+    output |= OUTPUT_ENABLE;
+
+    // this pulse starts the next measurement
+    cal_start = time;
+    cal_pulses = 1;
+  }
+
+  OUTPUT(output ^ output_set);
+}
+
+
+/*===========================================================================*/
+/*  Function: cal_save                                                       */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    writes the result of the last measurement to the EEPROM, called from   */
+/*    the main loop, only the bytes changed are written                      */
+/*===========================================================================*/
+static void cal_save(void)
+{
+  CAL_STATE state;
+
+  cli();
+  state = cal_result;
+  cal_pending = 0;
+  sei();
+
+  state.crc = crc8(&state, offsetof(CAL_STATE, crc));
+  eeprom_update_block(&state, &cal_saved, sizeof(state));
+}
+#endif
+
+
+#ifdef USE_SYNC
+/*===========================================================================*/
+/*  Function: sync_pulse                                                     */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    pin change of the sync input, called by the interrupt                  */
+/*                                                                           */
+/*    at the falling edge Timer0 is restarted with its prescaler, so the     */
+/*    next tick comes a whole tick after the edge, whatever the phase of the */
+/*    current one, and the cycle of the set starts again as after a reset,   */
+/*    the outputs of the first tick computed; the foxes on the same line     */
+/*    are aligned to the cycles of the interrupt entry, the same for all     */
+/*    woken from power-down, the counts of the oscillator start-up are       */
+/*    already elapsed, the ticks go on from the edge                         */
+/*    the input is disabled for SYNC_LOCKOUT_TICKS, the bounces of the edge  */
+/*    and the rising edge of the pulse are not seen                          */
+/*    the trace records the phase of the fox at the edge before its start    */
+/*===========================================================================*/
+static inline void sync_pulse(void)
+{
+#ifdef USE_TRACE
+  uint16_t phase_ticks;
+  uint8_t phase_count;
+#endif
+
+  if (PINA & SYNC_PIN)
+    return;
+
+#ifdef USE_TRACE
+  // the phase of the fox at the edge, the count before the restart, a
+  // tick due in the first half of the count is not yet counted
+  phase_count = TCNT0L;
+  phase_ticks = interval_ticks;
+  if ((TIFR & (1 << OCF0A)) && phase_count < TIMER0_TICK_COUNTS / 2)
+    phase_ticks++;
+#endif
+
+#ifdef USE_POWER_DOWN
+  if (power_state == POWER_DOWN)
+    TCNT0L = SYNC_WAKE_COUNTS;
+  else
+#endif
+  TCNT0L = 0;
+  GTCCR = 1 << PSR0;
+  TIFR = 1 << OCF0A;
+
+  PCMSK0 &= ~SYNC_PIN;
+  sync_lockout = SYNC_LOCKOUT_TICKS;
+
+#ifdef USE_POWER_DOWN
+  // the watchdog is stopped, the ticks are measured from the edge
+  if (power_state != POWER_RUN)
+  {
+    wdt_stop();
+    TIMSK = 1 << OCIE0A;
+    power_state = POWER_RUN;
+#ifdef USE_TRACE
+    // the ticks are counted at the wake-ups, the phase is not known
+    phase_count = TRACE_PHASE_UNKNOWN;
+#endif
+  }
+#endif
+#ifdef USE_BATTERY
+  // a measurement in the ADC sleep is finished in the idle sleep, Timer0
+  // runs on, and taken again
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  batt_pending = 1;
+#endif
+
+  // the outputs are turned off at once, the key by a ramp
+  output = 0;
+  OUTPUT(output ^ output_set);
+  OUTPUT_WRITE();
+#ifdef USE_KEY_SHAPE
+  shape_edge();
+#endif
+#ifdef USE_LED
+  led_ticks = 0;
+#endif
+
+#ifdef USE_SCHEDULE
+  // the schedule clock starts from the edge too
+  sched_ticks = 0;
+  sched_index = 0;
+  sched_ahead = sched_first;
+  sched_load();
+  if (!sched_window.start)
+    sched_event();
+#ifdef USE_LTC6903
+  else
+  {
+    frequency = LTC6903_OFF;
+    ltc_pending = 1;
+  }
+#endif
+#else
+  interval_ticks = interval_offset;
+  keying_ptr = keying;
+  key_ticks = lead + 1;
+  space_acc = 0;
+#endif
+#ifdef USE_TRACE
+  // the trace starts again from the edge
+  trace_phase(phase_ticks, phase_count);
+  trace_start(TRACE_SYNC);
+#endif
+  keying_tick();
+#ifdef USE_TRACE
+  trace_tick();
+#endif
+}
+#endif
+
+
+#if defined(USE_CALIBRATE) || defined(USE_SYNC)
+/*===========================================================================*/
+/*  Function: PCINT                                                          */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    Interrupt service routine for the pin change of the reference input    */
+/*    in the calibration mode, and of the sync input out of it               */
+/*===========================================================================*/
+ISR(PCINT_vect)
+{
+#ifdef USE_CALIBRATE
+  if (cal_mode)
+  {
+    cal_pulse();
+    return;
+  }
+#endif
+#ifdef USE_SYNC
+  sync_pulse();
+#endif
+}
+#endif
+
+
+#ifdef USE_FIXED
+/*===========================================================================*/
+/*  Function: dip_read                                                       */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - ticks the cycle of the fox is ahead of the cycle of the set      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the settings of the fixed configuration are constants, no switch is    */
+/*    read, only the frequency is loaded                                     */
+/*===========================================================================*/
+static uint16_t dip_read(void)
+{
+#if defined(USE_TELEMETRY) || defined(USE_TRACE)
+  CONFIG_DATA config =
+  {
+    FIXED_CODE, FIXED_SPEED, FIXED_PERIOD, FIXED_INTERVAL, FIXED_OFFSET
+  };
+#endif
+#ifdef USE_TELEMETRY
+  tlm_event(TLM_CONFIG, &config, sizeof(config));
+#endif
+#ifdef USE_TRACE
+  trace_event(TRACE_CONFIG, &config, sizeof(config));
+#endif
+#ifdef USE_PROG_FREQ
+  frequency = pgm_read_word(&frequencies[FIXED_FREQ]);
+#endif
+
+  return FIXED_OFFSET;
+}
+
+#else
+/*===========================================================================*/
+/*  Function: dip_get                                                        */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - first: first entry of the setting in the pin table               */
+/*        - bits: number of bits of the setting                              */
+/*  Return value:                                                            */
+/*        - value of the setting                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    reads a setting from its pins in the table generated from the pin map  */
+/*    (dip.h), from the most significant bit, an open switch reads as 1      */
+/*    a single loop serves every setting of every board variant, instead of  */
+/*    the shifts of every bit expanded at every read                         */
+/*===========================================================================*/
+static uint8_t dip_get(uint8_t first, uint8_t bits)
+{
+  const uint8_t *entry = &dip_pins[first];
+  uint8_t value = 0;
+  uint8_t pin;
+
+  do
+  {
+    pin = pgm_read_byte(entry++);
+    value <<= 1;
+    if (((pin & DIP_PORT_B) ? PINB : DIP_PINA) & (1 << (pin & 7)))
+      value |= 1;
+  }
+  while (--bits);
 
-/**** local function prototypes **********************************************/
-void init_uc(void);
+  return value;
+}
 
-/**** constants **************************************************************/
 
-// code points
-const PROGMEM uint8_t CODE_MO[6]  = { 0xee, 0x3b, 0xb8, 0 }; // 1110 1110 0011 1011 1011 1
-const PROGMEM uint8_t CODE_MOE[6] = { 0xee, 0x3b, 0xb8, 0x80, 0 }; // 1110 1110 0011 1011 1011 1000 1
-const PROGMEM uint8_t CODE_MOI[6] = { 0xee, 0x3b, 0xb8, 0xa0, 0 }; // 1110 1110 0011 1011 1011 1000 101
-const PROGMEM uint8_t CODE_MOS[6] = { 0xee, 0x3b, 0xb8, 0xa8, 0 }; // 1110 1110 0011 1011 1011 1000 1010 1
-const PROGMEM uint8_t CODE_MOH[6] = { 0xee, 0x3b, 0xb8, 0xaa, 0 }; // 1110 1110 0011 1011 1011 1000 1010 101
-const PROGMEM uint8_t CODE_MO5[6] = { 0xee, 0x3b, 0xb8, 0xaa, 0x80, 0 }; // 1110 1110 0011 1011 1011 1000 1010 1010 1
-const PROGMEM uint8_t CODE_S[6]   = { 0xa8, 0 }; // 1010 1
-
-#define CODE_MO_LEN 21
-#define CODE_MOE_LEN 25
-#define CODE_MOI_LEN 27
-#define CODE_MOS_LEN 29
-#define CODE_MOH_LEN 31
-#define CODE_MO5_LEN 23
-#define CODE_S_LEN 5
-
-// TODO: I have to find a better solution for this
-const PROGMEM uint8_t space_adjust[32] = {
-  10, 7, 8, 4,
-  6, 17, 4, 7,
-  11, 15, 10, 5,
-  9, 13, 10, 13,
-  7, 11, 8, 11,
-  5, 9, 6, 9,
-  9, 5, 5, 7,
-  10, 7, 8, 4,
-};
+/*===========================================================================*/
+/*  Function: dip_read                                                       */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - ticks the cycle of the fox is ahead of the cycle of the set      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    reads the dip-switches, and sets up the keying schedule, the interval  */
+/*    and the frequency of the code selected by them                         */
+/*    the pull-ups of the switches must be on                                */
+/*===========================================================================*/
+static uint16_t dip_read(void)
+{
+  uint8_t code;
+  uint8_t speed;
+  uint8_t length;
+  register uint8_t intervals;
+  uint16_t offset = 0;
+#if defined(USE_TELEMETRY) || defined(USE_TRACE)
+  CONFIG_DATA config;
+#endif
 
-#define SPACE_ADJUST(len,wpm,i) \
-  ((INTERVAL_COUNT(i) + (7 * TICKS_PER_SIGN(wpm))) % (((len) + 7) * TICKS_PER_SIGN(wpm))) / \
-  (TICKS_PER_SIGN(wpm)) / \
-  ((INTERVAL_COUNT(i) + (7 * TICKS_PER_SIGN(wpm))) / (((len) + 7) * TICKS_PER_SIGN(wpm)))
+  // D1-3 (PA7, PA6, PA5) code
+  code = DIP(CODE);
+#ifdef USE_SCHEDULE
+  // the settings of the schedule window override the switches
+  if (sched_window.code != SCHED_DIP)
+    code = sched_window.code;
+#endif
+  // the beacon message code keys MO if there is no message
+  if (code >= KEYING_CODES)
+    code = DIP_CODE_MO;
+  intervals = pgm_read_byte(&dip_positions[code]);
 
-#ifdef USE_PROG_FREQ
-const PROGMEM uint16_t frequencies[8] = {803, 810, 813, 820, 824, 827, 834, 837};
+  // code speed selects the schedule table of the code
+  speed = DIP(SPEED) != 0 ? 1 : 0;
+#ifdef USE_SCHEDULE
+  if (sched_window.speed != SCHED_DIP)
+    speed = sched_window.speed;
 #endif
+  keying = (const uint8_t *)pgm_read_ptr(&keying_table[code][speed]);
 
-/**** global variables *******************************************************/
+  // interval period short/long
+  length = DIP(INTERVAL_LENGTH) != 0 ? 1 : 0;
+  if (length)
+  {
+    enable_period = INTERVAL_COUNT(INTERVAL_SHORT);
+  }
+  else
+  {
+    enable_period = INTERVAL_COUNT(INTERVAL_LONG);
+  }
 
-uint8_t code[6];
-uint8_t* code_ptr;
-uint8_t ticks_per_sign;
-uint16_t enable_period;
-uint16_t interval;
-uint8_t output_set;
-uint8_t output;
-uint16_t interval_ticks;
-uint8_t key_ticks;
-uint8_t space_count;
-uint8_t bit;
-uint8_t space;
-#ifdef USE_LED
-uint16_t led_ticks;
-#endif
+  // interval mode
+  interval = pgm_read_word(&dip_intervals[length][DIP(INTERVAL)]);
+
+  // interword spacing computed at build time, so we get full words in
+  // an interval, the last one ending a word space before the TXOFF tone
+  if (!interval)
+  {
+    enable_period = 0;
+    length = KEYING_CONTINUOUS;
+  }
+  space = pgm_read_word(&keying_space[code][speed][length]);
+  space_rem = pgm_read_byte(&keying_space_rem[code][speed][length]);
+  space_mod = pgm_read_byte(&keying_space_mod[code][speed][length]);
+  lead = pgm_read_byte(&keying_lead[code][speed][length]);
+  // the foxes of a set transmit one after the other, every one of them
+  // starts its cycle earlier by the enable periods before its own
+  while (intervals--)
+  {
+    if (!offset)
+      offset = interval;
+    offset -= enable_period;
+  }
+
+  // frequency setting
 #ifdef USE_PROG_FREQ
-uint16_t frequency;
+#ifdef USE_SCHEDULE
+  if (sched_window.freq != SCHED_DIP)
+    frequency = pgm_read_word(&frequencies[sched_window.freq]);
+  else
+#endif
+  frequency = pgm_read_word(&frequencies[DIP(FREQ)]);
+#endif
+
+#if defined(USE_TELEMETRY) || defined(USE_TRACE)
+  config.code = code;
+  config.speed = speed;
+  config.enable_period = enable_period;
+  config.interval = interval;
+  config.offset = offset;
+#endif
+#ifdef USE_TELEMETRY
+  tlm_event(TLM_CONFIG, &config, sizeof(config));
+#endif
+#ifdef USE_TRACE
+  trace_event(TRACE_CONFIG, &config, sizeof(config));
+#endif
+
+  return offset;
+}
 #endif
 
-/**** local functions ********************************************************/
 
+#ifdef USE_DIP_SCAN
 /*===========================================================================*/
-/*  Function: TIMER0_COMPA                                                   */
+/*  Function: dip_scan                                                       */
 /*  Module:   main                                                           */
 /*===========================================================================*/
 /*  Parameters:                                                              */
@@ -105,91 +2585,188 @@ uint16_t frequency;
 /*        - none                                                             */
 /*===========================================================================*/
 /*  Description:                                                             */
-/*    Interrupt service routine for Timer0 Compare A module                  */
-/*    interrupt is executed periodically at every 8ms                        */
-/*                                                                           */
-/*    ATtiny261 does not have CTC functionality for 16bit mode, so only the  */
-/*    8 bit timer is used with CTC, so there is not enough resolution to     */
-/*    have a period equal to the morse code signs, these must be delayed     */
-/*    by software, counting enough periods for each sign                     */
-/*    when enough ticks are passed the next sign is determined and the       */
-/*    keying will be either turned on or turned off                          */
-/*    the periods are also counted for the interval timer, turning on/off    */
-/*    the whole transmitter                                                  */
-/*                                                                           */
+/*    samples the dip-switches of port A, the pull-ups are turned on only    */
+/*    for the few microseconds the lines need to settle, those of port B     */
+/*    too, a switch closed at reset has its pull-up off and is read again    */
+/*    with it; then the open switches of port B keep their pull-ups, as at   */
+/*    reset, an opened one does not float                                    */
+/*    a changed setting is applied at once: with the same interval the fox   */
+/*    keeps the phase of its set and moves to the window of its new code,    */
+/*    otherwise its cycle starts again as after a reset, a window already    */
+/*    running is keyed from its next tick                                    */
+/*    the switches of port B are read again only with a port A change, the   */
+/*    key and enable levels are not changed without a reset                  */
 /*===========================================================================*/
-ISR(TIMER0_COMPA_vect)
+static void dip_scan(void)
 {
-  // check if output is enabled
-  if (!interval || interval_ticks++ < enable_period)
+  uint8_t dips;
+  uint16_t phase;
+  uint16_t old_interval;
+  uint16_t old_period;
+
+  DIDR0 = 0x00;
+  PORTA = 0xFF;
+  PORTB |= PORTB_DIP_PINS;
+  _delay_loop_1(DIP_SETTLE_LOOPS);
+  dips = DIP_PINA;
+
+  if (dips != dip_state)
   {
-    // set output enable pin if necessary
-    output |= OUTPUT_ENABLE;
+    dip_state = dips;
 
-    // in interval mode, key the transmitter for the last 2 seconds
-    if (interval && interval_ticks > enable_period - TXOFF_TICKS)
-    {
-      output |= OUTPUT_KEY;
-    }
-    if (!key_ticks--)
-    {
-      key_ticks = ticks_per_sign - 1;
+    // ticks since the start of the cycle of the set
+    phase = interval_ticks - interval_offset;
+    if (interval_ticks < interval_offset)
+      phase += interval;
 
-      if ( space_count >= space )
-      {
-        code_ptr = code;
-        bit = 0x80;
-        space_count = 0;
-      }
-      if ( *code_ptr & bit )
-      {
-        output |= OUTPUT_KEY;
-        space_count = 0;
-      }
-      else
-      {
-        output &= ~OUTPUT_KEY;
-        space_count++;
-      }
-      bit >>= 1;
-      if ( !bit )
-      {
-        if ( *code_ptr )
-          code_ptr++;
-        bit = 0x80;
-      }
-    }
+    old_interval = interval;
+    old_period = enable_period;
+    interval_offset = dip_read();
+    if (interval != old_interval || enable_period != old_period)
+      phase = 0;
 
-#ifdef USE_LED
-    if (led_ticks >= ENABLED_LED_TICKS)
-      led_ticks = 0;
+    interval_ticks = phase + interval_offset;
+    if (interval && interval_ticks >= interval)
+      interval_ticks -= interval;
+
+    // a new word: after the lead-in in the off-period, at the next tick
+    // in the window, after a word space in continuous keying
+    keying_ptr = keying;
+    space_acc = 0;
+    if (!interval)
+      key_ticks = space;
+    else if (interval_ticks < enable_period)
+      key_ticks = 1;
+    else
+      key_ticks = lead + 1;
+
+#ifdef USE_LTC6903
+    ltc_pending = 1;
+#endif
+#ifdef USE_RESUME
+    resume_state.dips = dips;
 #endif
   }
-  else
-  {
-    output &= ~(OUTPUT_ENABLE | OUTPUT_KEY);
-    space_count = space + 1;
-    key_ticks = 0;
 
-#ifdef USE_LED
-    if (led_ticks >= enable_period)
-      led_ticks = 0;
+  DIDR0 = (uint8_t)~SYNC_PIN;
+  PORTA = SYNC_PIN;
+  PORTB = (PORTB & ~PORTB_DIP_PINS) | (PINB & PORTB_DIP_PINS);
+}
 #endif
-  }
 
-#ifdef USE_LED
-  if (led_ticks++ != 0)
+
+#ifdef USE_RESUME
+/*===========================================================================*/
+/*  Function: resume_init                                                    */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    after a warm reset (brown-out, external) the cycle of the set is       */
+/*    continued, with the ticks lost by the reset added: from the RAM copy   */
+/*    if it is intact, otherwise from the newest slot of the EEPROM ring,    */
+/*    which is up to RESUME_SAVE_TICKS old, half of it is added              */
+/*    the saved state is used only if the port A switches are the same, a    */
+/*    power-on reset starts a new cycle, as the whole set is turned on       */
+/*    a window already running is keyed with a new word from the next tick   */
+/*    the next save goes to the slot after the newest one                    */
+/*    the pull-ups of the switches must be on                                */
+/*===========================================================================*/
+static void resume_init(void)
+{
+  RESUME_STATE state;
+  RESUME_STATE saved = { 0, 0, 0, 0 };
+  uint8_t found = 0;
+  uint8_t flags;
+  uint8_t dips;
+  uint8_t slot;
+  uint16_t ticks;
+
+  flags = MCUSR;
+  MCUSR = 0;
+  dips = DIP_PINA;
+
+  // the newest slot has the largest save number, the numbers of the ring
+  // are within RESUME_SLOTS of each other
+  for (slot = 0; slot < RESUME_SLOTS; slot++)
   {
-    LED_OFF();
+    eeprom_read_block(&state, &resume_ring[slot], sizeof(state));
+    if (state.crc != crc8(&state, offsetof(RESUME_STATE, crc)))
+      continue;
+    if (!found || (int8_t)(state.seq - saved.seq) > 0)
+    {
+      saved = state;
+      resume_slot = slot + 1;
+      found = 1;
+    }
   }
-  else
+  if (resume_slot == RESUME_SLOTS)
+    resume_slot = 0;
+
+  if (interval && !(flags & (1 << PORF)))
   {
-    LED_ON();
+    ticks = interval_ticks;
+    if (resume_state.crc == crc8(&resume_state, offsetof(RESUME_STATE, crc)) && resume_state.dips == dips)
+      ticks = resume_state.interval_ticks + RESUME_RESET_TICKS;
+    else if (found && saved.dips == dips)
+      ticks = saved.interval_ticks + RESUME_RESET_TICKS + RESUME_SAVE_TICKS / 2;
+
+    while (ticks >= interval)
+      ticks -= interval;
+    interval_ticks = ticks;
+    if (interval_ticks < enable_period)
+      key_ticks = 1;
   }
+
+  // the state of this cycle, the save numbers continue the ring
+  resume_state.dips = dips;
+  resume_state.seq = found ? saved.seq : 0;
+  resume_state.interval_ticks = interval_ticks;
+  resume_state.crc = crc8(&resume_state, offsetof(RESUME_STATE, crc));
+}
 #endif
 
-  OUTPUT(output ^ output_set);
+
+#ifdef USE_CALIBRATE
+/*===========================================================================*/
+/*  Function: cal_init                                                       */
+/*  Module:   main                                                           */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    in the calibration mode the outputs are turned off and the pin change  */
+/*    interrupt of the reference input enabled, otherwise the tick           */
+/*    correction is loaded from the EEPROM, if it was saved                  */
+/*===========================================================================*/
+static void cal_init(void)
+{
+  CAL_STATE state;
+
+  if (cal_mode)
+  {
+    // the input is kept on by the switch sampling too
+    DIDR0 &= ~CAL_PIN;
+    PCMSK0 = CAL_PIN;
+    PCMSK1 = 0;
+    GIMSK = 1 << PCIE1;
+    output = 0;
+    OUTPUT(output ^ output_set);
+    return;
+  }
+
+  eeprom_read_block(&state, &cal_saved, sizeof(state));
+  if (state.crc == crc8(&state, offsetof(CAL_STATE, crc)))
+    cal_step = state.step;
 }
+#endif
 
 
 /*===========================================================================*/
@@ -209,87 +2786,90 @@ ISR(TIMER0_COMPA_vect)
 /*===========================================================================*/
 void init_uc(void)
 {
-  const uint8_t * ptr;
-  uint8_t * dst = code;
-  register uint8_t intervals;
-  int i;
+#if defined(USE_TELEMETRY) || defined(USE_TRACE)
+  uint8_t flags;
+#endif
 
   // analog comparator is not used, disable to reduce power
   ACSRA = (1 << ACD);
-  // also allow reducing power for all but Timer0 (and USI if needed)
-  PRR = (1 << PRTIM1) |
+  // also allow reducing power for all but the tick timer (and USI if needed)
+  PRR =
+#ifdef USE_TICKLESS
+        (1 << PRTIM0) |
+#elif !defined(USE_TELEMETRY) && !defined(USE_KEY_SHAPE)
+        (1 << PRTIM1) |
+#endif
 #ifndef USE_SPI
         (1 << PRUSI) |
 #endif
         (1 << PRADC);
 
   // setup ports:
+#ifdef USE_FIXED
+  // the switches are not read, port A is driven low: a closed switch
+  // shorts nothing, and no pull-up current flows, only the sync input
+  // keeps its pull-up
+  PORTA = SYNC_PIN;
+  DDRA = (uint8_t)~SYNC_PIN;
+#else
   // porta all input with pullup
   PORTA = 0xFF;
   DDRA = 0x00;
+#endif
   // some PORTB pins have alternate functionality, some have output pins
   // and some have config bits on them, including some multiple use pins
   // initially set only the inputs, to determine the default states
   PORTB = PORTB_DIP_PINS;
   DDRB = 0x00;
 
-  // read dip-switch settings
-  // code speed
-  if (DIP(SPEED) != 0)
-    ticks_per_sign = TICKS_PER_SIGN(CODE_SPEED_FAST);
-  else
-    ticks_per_sign = TICKS_PER_SIGN(CODE_SPEED_SLOW);
-
-  // interval period short/long
-  if (DIP(INTERVAL_LENGTH) != 0)
-  {
-    enable_period = INTERVAL_COUNT(INTERVAL_SHORT);
-  }
-  else
-  {
-    enable_period = INTERVAL_COUNT(INTERVAL_LONG);
-  }
-
-  // interval mode
-  SET_INTERVAL_VALUE(interval, enable_period);
-
-  if (interval)
-  {
-    // adjust the interword spacing we get full words in an interval
-    space = pgm_read_byte(&space_adjust[DIP(INTERVAL) & 0x03]);
-  }
-  else
-  {
-    enable_period = 0;
-    space = 7;
-  }
-
-    // D1-3 (PA7, PA6, PA5) code
-  switch ( DIP(CODE) )
-  {
-    case DIP_CODE_MOE:  ptr = CODE_MOE; intervals = 0; break;
-    case DIP_CODE_MOI:  ptr = CODE_MOI; intervals = 1; break;
-    case DIP_CODE_MOS:  ptr = CODE_MOS; intervals = 2; break;
-    case DIP_CODE_MOH:  ptr = CODE_MOH; intervals = 3; break;
-    case DIP_CODE_MO5:  ptr = CODE_MO5; intervals = 4; break;
-    case DIP_CODE_S:    ptr = CODE_S;   intervals = 0; break;
-    default: ptr = CODE_MO;  intervals = 0;
-  }
-  for (i = 0; i < 6; i++)
-    *dst++ = pgm_read_byte(ptr++);
+#if defined(USE_TELEMETRY) || defined(USE_TRACE)
+  // the reset flags, cleared by resume_init() with RESUME
+  flags = MCUSR;
+#ifdef USE_TELEMETRY
+  tlm_event(TLM_RESET, &flags, sizeof(flags));
+#endif
+#ifndef USE_RESUME
+  MCUSR = 0;
+#endif
+#endif
+#ifdef USE_TRACE
+  // the records of this run follow the newest ones in the EEPROM
+  trace_init();
+#endif
 
-  if (intervals)
+#ifdef USE_SCHEDULE
+  // the first window, keyed from the power-on if it starts there
+  eeprom_read_block(&sched_ahead, &sched_table[0], sizeof(sched_ahead));
+#ifdef USE_SYNC
+  sched_first = sched_ahead;
+#endif
+  sched_load();
+  if (!sched_window.start)
   {
-    interval_ticks = interval;
-    do
-    {
-      interval_ticks -= enable_period;
-    } while (intervals-- && interval_ticks > enable_period);
+    sched_state = SCHED_RUN;
+    sched_next = sched_window.end;
   }
+#endif
 
-  // frequency setting
-#ifdef USE_PROG_FREQ
-  frequency = pgm_read_word(&frequencies[DIP(FREQ)]);
+  // read dip-switch settings
+  interval_ticks = dip_read();
+#if defined(USE_DIP_SCAN) || defined(USE_SYNC)
+  interval_offset = interval_ticks;
+#endif
+  // start with a new word at the first tick
+  keying_ptr = keying;
+  key_ticks = lead + 1;
+#ifdef USE_RESUME
+  // continue the cycle of the set after a warm reset
+  resume_init();
+#endif
+#ifdef USE_CALIBRATE
+  // calibration mode, selected by a code value
+  cal_mode = DIP(CODE) == CAL_CODE;
+#endif
+#ifdef USE_BATTERY
+  // the battery is measured at the first tick too
+  batt_pending = 1;
 #endif
 
   // if we write back the dip-switch settings to the port pin
@@ -301,60 +2881,134 @@ void init_uc(void)
   // the off switches shall preserve the pullup, to have the PIN on
   // a stable level
   // this reduces power consumption by 100uA for every turned on switch
-  PORTA = PINA;
+#ifdef USE_DIP_SCAN
+  // when the switches are sampled at the window boundaries, all pull-ups
+  // are off and the digital inputs disabled in between, so none of the
+  // switches draws current, the sync input keeps its pull-up
+  dip_state = DIP_PINA;
+  DIDR0 = (uint8_t)~SYNC_PIN;
+  PORTA = SYNC_PIN;
+#elif !defined(USE_FIXED)
+  PORTA = DIP_PINA;
+#endif
 
   // key level, enable level
-#ifdef USE_LEVEL_SETTING
+#if defined(USE_LEVEL_SETTING) && !defined(USE_FIXED)
   output_set = (DIP(KEY_LEVEL) != 0 ? 0 : OUTPUT_KEY) | (DIP(ENABLE_LEVEL) != 0 ? 0 : OUTPUT_ENABLE);
 #endif
   PORTB = output_set |
 #ifdef USE_SPI
           USI_DO | OSC_SEN |
 #endif
+#ifdef USE_FIXED
+          // the pull-up of the USI DO is kept, the other switch pins are
+          // driven low
+          (PORTB_DIP_PINS & ~PORTB_DIP_ONLY_PINS);
+#else
           (PINB & PORTB_DIP_PINS);
+#endif
 
-#ifdef USE_LTC6309
-  DDRB = USI_DO | USI_SCK | OSC_SEN;
-
-  // configure oscillator using SPI interface
-  // high byte (OCT3:0 DAC9:6) OCT = 11, DAC from frequency
-  PORTB &= ~OSC_SEN;
-  USIDR = (11 << 4) | (frequency >> 6);
-  USISR = 1 << USIOIF;
+#ifdef USE_LTC6903
+  // configure oscillator using SPI interface, turned off until the start
+  // of the first window
+#ifdef USE_SCHEDULE
+  if (sched_state != SCHED_RUN)
+    frequency = LTC6903_OFF;
+#endif
+  ltc_write(frequency);
+#endif
 
-  do
-  {
-    USICR = (1 << USIWM0) | (1 << USICS1) | (1 << USICLK) | (1 << USITC);
-  } while (!(USISR & (1 << USIOIF)));
-  // low byte (DAC5:0 CNF1:0) DAC from frecuency, CNF 10 (CLKN disabled)
-  USIDR = ((frequency & 0x3F) << 2) | 0x02;
-  USISR = 1 << USIOIF;
-  do
+#ifdef USE_KEY_SHAPE
+  // the key pin is driven by the Timer1 PWM, OC1B is set to the off level
+  // by a forced compare match in normal mode first, then kept by the duty
+  // of 0 or TOP; the calibration mode keys the port bit
+#ifdef USE_CALIBRATE
+  if (!cal_mode)
+#endif
   {
-    USICR = (1 << USIWM0) | (1 << USICS1) | (1 << USICLK) | (1 << USITC);
-  } while (!(USISR & (1 << USIOIF)));
-  PORTB |= OSC_SEN | USI_SCK | USI_DO;
-  DDRB &= ~(USI_DO | USI_SCK | OSC_SEN);
-
-  // disable USI, and set port to pullups where needed
-  USICR = 0;
-  PRR |= (1 << PRUSI);
-  // clear pullup if USI_DO pin is pulled down
-  if (!(PINB & USI_DO))
-    PORTB &= ~USI_DO;
+    shape_key = output_set & OUTPUT_KEY;
+    TC1H = 0;
+    OCR1C = KEY_SHAPE_TOP;
+    OCR1B = shape_key ? KEY_SHAPE_TOP : 0;
+    TCCR1A = (1 << COM1B1) | (shape_key ? 1 << COM1B0 : 0);
+    TCCR1A |= 1 << FOC1B;
+    TCCR1D = 1 << WGM10;
+    TCCR1A = (1 << COM1B1) | (1 << PWM1B);
+  }
 #endif
 
   DDRB |=
 #ifdef USE_LED
           OUTPUT_LED |
+#endif
+#ifdef USE_FIXED
+          PORTB_DIP_ONLY_PINS |
 #endif
           OUTPUT_ENABLE | OUTPUT_KEY;
 
+  // the outputs of the first tick, the trace starts with them
+#ifdef USE_CALIBRATE
+  cal_init();
+  if (!cal_mode)
+#endif
+  {
+#ifdef USE_TRACE
+    trace_start(flags);
+#endif
+    keying_tick();
+#ifdef USE_TRACE
+    trace_tick();
+#endif
+  }
+#ifdef USE_SYNC
+  // the sync input, not in the calibration mode
+#ifdef USE_CALIBRATE
+  if (!cal_mode)
+#endif
+  {
+    PCMSK0 = SYNC_PIN;
+    PCMSK1 = 0;
+    GIMSK = 1 << PCIE1;
+  }
+#endif
+
+  // only the keying is left, the clock can be slowed down, the timers are
+  // set up for the divided clock
+#if CLOCK_DIV_LOG2
+  clock_set(CLOCK_DIV_LOG2);
+#endif
+
+#ifdef USE_TICKLESS
+  // setup timer: Timer1 free running with 10 bit period, first compare
+  // at the first tick, rounded to the nearest count
+  TCCR1A = 0;
+  TCCR1C = 0;
+  TCCR1D = 0;
+  TC1H = TICKLESS_TOP >> 8;
+  OCR1C = TICKLESS_TOP & 0xFF;
+  tickless_frac = 4 + TICKLESS_COUNTS_X8;
+  tickless_ocr = tickless_frac >> 3;
+  tickless_frac &= 7;
+  TC1H = tickless_ocr >> 8;
+  OCR1A = tickless_ocr & 0xFF;
+  TCCR1B = TICKLESS_CS;
+  TIMSK = 1 << OCIE1A;
+#else
   // setup timer: CTC interrupt at 8ms
   TCCR0A = 0x01;
-  TCCR0B = 0x04;
-  OCR0A = TICKS_PER_SECOND - 1;
+  TCCR0B = TIMER0_CS;
+  OCR0A = TIMER0_TICK_COUNTS - 1;
+#ifdef USE_LED_PULSE
+  OCR0B = LED_PULSE_COUNTS - 1;
+#endif
   TIMSK = 1 << OCIE0A;
+#endif
+#ifdef USE_TELEMETRY
+  // Timer1 counts the cycles of the tick interrupt
+  TC1H = TLM_CYCLE_TOP >> 8;
+  OCR1C = TLM_CYCLE_TOP & 0xFF;
+  TCCR1B = 1 << CS10;
+#endif
 }
 
 
@@ -383,7 +3037,90 @@ int main(void)
   // then do nothing
   while (1)
   {
+#ifdef USE_LTC6903
+    // retune the oscillator when the keying asks for it, in the off-period
+    // a new frequency word can be set at any time, it is written then
+    if (ltc_pending)
+    {
+      cli();
+      clock_fast();
+      ltc_write(frequency);
+      clock_slow();
+      ltc_pending = 0;
+      sei();
+    }
+#endif
+
+#ifdef USE_RESUME
+    // the state is saved to the EEPROM ring, the keying goes on meanwhile
+    if (resume_pending)
+      resume_save();
+#endif
+
+#ifdef USE_CALIBRATE
+    // the calibration measured is saved
+    if (cal_pending)
+      cal_save();
+#endif
+
+#ifdef USE_BATTERY
+    // the battery is measured in the ADC noise reduction sleep
+    if (batt_pending)
+      batt_measure();
+#endif
+
+#ifdef USE_TELEMETRY
+    // the records are sent between the ticks
+    if (tlm_tail != tlm_head)
+      tlm_drain();
+#endif
+
+#ifdef USE_TRACE
+    // the trace is written to the EEPROM log, the keying goes on meanwhile
+    if (trace_pending)
+      trace_flush();
+#endif
+
+#ifdef USE_SCHEDULE
+    // the window after the current one is read ahead
+    if (sched_ahead_pending)
+      sched_read_ahead();
+
+    // after the last window the MCU is turned off, with the outputs of the
+    // last tick written, only a reset wakes it
+    if (sched_state == SCHED_OFF && OUTPUT_PORT == OUTPUT_NEXT
+#ifdef USE_KEY_SHAPE
+        && !SHAPE_BUSY()
+#endif
+       )
+    {
+      cli();
+#ifdef USE_POWER_DOWN
+      wdt_stop();
+#endif
+      TIMSK = 0;
+      set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+      sleep_enable();
+      sleep_cpu();
+    }
+#endif
+
+#ifdef USE_POWER_DOWN
+    // the sleep mode is selected with the interrupts disabled, sei() takes
+    // effect after the next instruction, so no interrupt can change the
+    // power state before the sleep
+    cli();
+    if (power_state == POWER_DOWN)
+      set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    else
+      set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+#else
     sleep_mode();
+#endif
   }
   
 
@@ -0,0 +1,30 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: eeprom.h                                                        */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - host replacement of <avr/eeprom.h> for the simulator build            */
+/*     the EEPROM variables are kept in a section of their own, which is not */
+/*     cleared by a simulated reset, the writes take no simulated time       */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef __SIM_AVR_EEPROM_H__
+#define __SIM_AVR_EEPROM_H__
+
+#include <stdint.h>
+#include <string.h>
+
+#define EEMEM __attribute__((section("fw_eeprom")))
+
+#define eeprom_read_block(dst, src, size) memcpy((dst), (src), (size))
+#define eeprom_update_block(src, dst, size) memcpy((dst), (src), (size))
+#define eeprom_read_byte(src) (*(const uint8_t *)(src))
+#define eeprom_update_byte(dst, value) (*(uint8_t *)(dst) = (value))
+
+#endif /*__SIM_AVR_EEPROM_H__*/
@@ -0,0 +1,28 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: interrupt.h                                                     */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - host replacement of <avr/interrupt.h> for the simulator build         */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef __SIM_AVR_INTERRUPT_H__
+#define __SIM_AVR_INTERRUPT_H__
+
+#include "../sim.h"
+
+// interrupt vectors are plain functions, called by the simulator when the
+// corresponding source fires and the global interrupt flag is set
+#define ISR(vector, ...) void vector(void); void vector(void)
+#define EMPTY_INTERRUPT(vector) void vector(void); void vector(void) {}
+
+#define sei() (sim_sreg_i = 1)
+#define cli() (sim_sreg_i = 0)
+
+#endif /*__SIM_AVR_INTERRUPT_H__*/
@@ -0,0 +1,222 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: io.h                                                            */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - host replacement of <avr/io.h> for the simulator build                */
+/*     the ATtiny261/461/861 registers used by the firmware are mapped to    */
+/*     the simulated register file, the PINx registers are computed from the */
+/*     simulated DIP switches and the pull-up settings, the Timer0 counter   */
+/*     from the simulated time, the ADC result at the end of the conversion  */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef __SIM_AVR_IO_H__
+#define __SIM_AVR_IO_H__
+
+#include <stdint.h>
+
+#include "../sim.h"
+
+// the firmware entry point is renamed for the host build (-Dmain=...),
+// provide its prototype here so the firmware compiles without warnings
+int main(void);
+
+// port registers
+#define PORTA   sim_io.porta
+#define DDRA    sim_io.ddra
+#define PINA    sim_pin_read(SIM_PORT_A)
+#define PORTB   sim_io.portb
+#define DDRB    sim_io.ddrb
+#define PINB    sim_pin_read(SIM_PORT_B)
+
+// power reduction, analog comparator and digital input disable
+#define PRR     sim_io.prr
+#define ACSRA   sim_io.acsra
+#define DIDR0   sim_io.didr0
+
+// Timer/Counter0
+#define TCCR0A  sim_io.tccr0a
+#define TCCR0B  sim_io.tccr0b
+#define OCR0A   sim_io.ocr0a
+#define OCR0B   sim_io.ocr0b
+#define TCNT0L  (*sim_tcnt0())
+#define TIMSK   sim_io.timsk
+#define TIFR    (*sim_tifr())
+
+// general timer control, the Timer0 prescaler reset is applied at the next
+// access of the counter, as its writes
+#define GTCCR   sim_io.gtccr
+
+// Timer/Counter1, the 10 bit registers latch TC1H when the low byte is
+// written, and the counter sets it when read, as the hardware does
+#define TCCR1A  sim_io.tccr1a
+#define TCCR1B  sim_io.tccr1b
+#define TCCR1C  sim_io.tccr1c
+#define TCCR1D  sim_io.tccr1d
+#define TC1H    sim_io.tc1h
+#define TCNT1   (*sim_tcnt1())
+#define OCR1A   (*(sim_io.ocr1a_hi = sim_io.tc1h, &sim_io.ocr1a))
+#define OCR1B   (*(sim_io.ocr1b_hi = sim_io.tc1h, &sim_io.ocr1b))
+#define OCR1C   (*(sim_io.ocr1c_hi = sim_io.tc1h, &sim_io.ocr1c))
+
+// USI, the clock strobe written to USICR is executed at the next access
+#define USICR   (*sim_usi(&sim_io.usicr))
+#define USISR   (*sim_usi(&sim_io.usisr))
+#define USIDR   (*sim_usi(&sim_io.usidr))
+
+// MCU control
+#define MCUCR   sim_io.mcucr
+#define MCUSR   sim_io.mcusr
+#define CLKPR   sim_io.clkpr
+
+// watchdog
+#define WDTCR   sim_io.wdtcr
+
+// pin change interrupt
+#define GIMSK   sim_io.gimsk
+#define PCMSK0  sim_io.pcmsk0
+#define PCMSK1  sim_io.pcmsk1
+
+// ADC, the conversion result is read as a word
+#define ADMUX   sim_io.admux
+#define ADCSRA  sim_io.adcsra
+#define ADCSRB  sim_io.adcsrb
+#define ADCW    sim_io.adcw
+
+// general purpose I/O registers
+#define GPIOR0  sim_io.gpior0
+
+// ACSRA bits
+#define ACD     7
+
+// PRR bits
+#define PRTIM1  3
+#define PRTIM0  2
+#define PRUSI   1
+#define PRADC   0
+
+// TCCR0A bits
+#define TCW0    7
+#define CTC0    0
+
+// TCCR0B bits
+#define CS02    2
+#define CS01    1
+#define CS00    0
+
+// GTCCR bits
+#define TSM     7
+#define PSR0    0
+
+// TIMSK/TIFR bits
+#define OCIE0A  4
+#define OCIE0B  3
+#define OCF0A   4
+#define OCF0B   3
+
+// TCCR1A bits
+#define COM1A1  7
+#define COM1A0  6
+#define COM1B1  5
+#define COM1B0  4
+#define FOC1A   3
+#define FOC1B   2
+#define PWM1A   1
+#define PWM1B   0
+
+// TCCR1B bits
+#define PWM1X   7
+#define PSR1    6
+#define CS13    3
+#define CS12    2
+#define CS11    1
+#define CS10    0
+
+// TIMSK/TIFR bits of Timer1
+#define OCIE1D  7
+#define OCIE1A  6
+#define OCIE1B  5
+#define TOIE1   2
+#define OCF1A   6
+#define TOV1    2
+
+// TCCR1D bits
+#define WGM11   1
+#define WGM10   0
+
+// USICR bits
+#define USISIE  7
+#define USIOIE  6
+#define USIWM1  5
+#define USIWM0  4
+#define USICS1  3
+#define USICS0  2
+#define USICLK  1
+#define USITC   0
+
+// USISR bits
+#define USISIF  7
+#define USIOIF  6
+#define USIPF   5
+#define USIDC   4
+
+// GIMSK bits, PCIE1 enables PCINT7:0 and PCINT15:12
+#define PCIE1   5
+#define PCIE0   4
+
+// ADMUX bits
+#define REFS1   7
+#define REFS0   6
+#define ADLAR   5
+#define MUX0    0
+
+// ADCSRA bits
+#define ADEN    7
+#define ADSC    6
+#define ADATE   5
+#define ADIF    4
+#define ADIE    3
+#define ADPS2   2
+#define ADPS1   1
+#define ADPS0   0
+
+// ADCSRB bits
+#define REFS2   4
+#define MUX5    3
+
+// MCUCR bits
+#define PUD     6
+#define SE      5
+#define SM1     4
+#define SM0     3
+
+// MCUSR bits
+#define WDRF    3
+#define BORF    2
+#define EXTRF   1
+#define PORF    0
+
+// CLKPR bits
+#define CLKPCE  7
+#define CLKPS3  3
+#define CLKPS2  2
+#define CLKPS1  1
+#define CLKPS0  0
+
+// WDTCR bits
+#define WDIF    7
+#define WDIE    6
+#define WDP3    5
+#define WDCE    4
+#define WDE     3
+#define WDP2    2
+#define WDP1    1
+#define WDP0    0
+
+#endif /*__SIM_AVR_IO_H__*/
@@ -0,0 +1,28 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: pgmspace.h                                                      */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - host replacement of <avr/pgmspace.h> for the simulator build          */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef __SIM_AVR_PGMSPACE_H__
+#define __SIM_AVR_PGMSPACE_H__
+
+#include <stdint.h>
+
+// the host has a single address space, flash data is ordinary const data
+#define PROGMEM
+
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(void * const *)(addr))
+
+#endif /*__SIM_AVR_PGMSPACE_H__*/
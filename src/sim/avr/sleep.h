@@ -0,0 +1,35 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: sleep.h                                                         */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - host replacement of <avr/sleep.h> for the simulator build             */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef __SIM_AVR_SLEEP_H__
+#define __SIM_AVR_SLEEP_H__
+
+#include "../sim.h"
+
+// sleep modes, selected by the SM1:SM0 bits of MCUCR
+#define SLEEP_MODE_IDLE       0
+#define SLEEP_MODE_ADC        (1 << SM0)
+#define SLEEP_MODE_PWR_DOWN   (1 << SM1)
+
+#define set_sleep_mode(mode) (MCUCR = (MCUCR & ~((1 << SM1) | (1 << SM0))) | (mode))
+#define sleep_enable() (MCUCR |= (1 << SE))
+#define sleep_disable() (MCUCR &= ~(1 << SE))
+
+// sleeping is the point where simulated time passes: the simulator advances
+// to the next interrupt source enabled in the sleep mode and executes its
+// handler
+#define sleep_cpu() sim_sleep()
+#define sleep_mode() do { sleep_enable(); sleep_cpu(); sleep_disable(); } while (0)
+
+#endif /*__SIM_AVR_SLEEP_H__*/
@@ -0,0 +1,23 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: wdt.h                                                           */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - host replacement of <avr/wdt.h> for the simulator build               */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef __SIM_AVR_WDT_H__
+#define __SIM_AVR_WDT_H__
+
+#include "../sim.h"
+
+// the watchdog counter restarts at the wdr instruction
+#define wdt_reset() sim_wdt_reset()
+
+#endif /*__SIM_AVR_WDT_H__*/
@@ -0,0 +1,406 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: foxenergy.c                                                     */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - energy budget of the DIP switch settings on the host simulator        */
+/*     simulates every setting (code, code speed, interval length and        */
+/*     interval mode) for the length of an event, and estimates the charge   */
+/*     drawn: the MCU active in the interrupts, in idle sleep and in         */
+/*     power-down, the LED, the pull-ups of the closed switches and the      */
+/*     transmitter while it is enabled                                       */
+/*     the simulated firmware takes no time, the active time is a number of  */
+/*     cycles for every interrupt, and the currents are typical datasheet    */
+/*     figures at 3 V, so the results compare the settings and the builds    */
+/*     rather than measure a board                                           */
+/*     the simulator state is global, so every setting runs in its own       */
+/*     process, as many in parallel as there are processors                  */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - first implementation                                      */
+/*                                                                           */
+/*****************************************************************************/
+
+/**** include files **********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "sim.h"
+#include "config.h"
+#include "codes.h"
+
+/**** constants **************************************************************/
+
+// supply current of the MCU at 3 V: active and in idle sleep per MHz of
+// the system clock, in power-down with the watchdog running
+#define ACTIVE_UA_PER_MHZ 350.0
+#define IDLE_UA_PER_MHZ 90.0
+#define POWER_DOWN_UA 4.0
+
+// current of an input pull-up into a closed switch
+#define PULLUP_UA 100.0
+
+// settings: code, code speed, interval length and interval mode switches
+#define MAX_SETTINGS ((DIP_CODE_MSG + 1) * 2 * 2 * (1 << DIP_INTERVAL_BITS))
+
+// state of a simulated setting
+#define SETTING_NEW 0
+#define SETTING_DONE 1
+#define SETTING_CONFLICT 2
+#define SETTING_FAILED 3
+
+/**** local types ************************************************************/
+
+// results of a setting, in memory shared with the parent process: the
+// times in clock source cycles, the pull-up time summed for every switch
+typedef struct
+{
+  int state;
+  uint32_t irqs;
+  uint64_t power_down;
+  uint64_t pullup;
+  uint64_t led;
+  uint64_t enable;
+} SETTING;
+
+// charge drawn in microampere seconds
+typedef struct
+{
+  double mcu;
+  double led;
+  double pullup;
+  double tx;
+} CHARGE;
+
+/**** local function prototypes **********************************************/
+static void usage(const char *name);
+static void print_setting(int index);
+static void trace_output(const SIM_OUTPUT *out);
+static void run_setting(int index, SETTING *setting, uint64_t cycles);
+static double estimate(const SETTING *setting, uint64_t cycles, double wake_cycles,
+                       double led_ma, double tx_ma, CHARGE *charge);
+
+/**** local variables ********************************************************/
+
+// setting being simulated by the process, the time of the last output
+// change and the levels since then
+static SETTING *trace_setting;
+static uint64_t trace_time;
+static int trace_led;
+static int trace_enable;
+
+/**** local functions ********************************************************/
+
+/*===========================================================================*/
+/*  Function: usage                                                          */
+/*  Module:   foxenergy                                                      */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - name: program name                                               */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the command line help                                           */
+/*===========================================================================*/
+static void usage(const char *name)
+{
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  -t hours      length of the event (default: 3)\n"
+          "  -j jobs       settings simulated in parallel (default: processors)\n"
+          "  -c cycles     MCU cycles of an interrupt (default: 100)\n"
+          "  -L mA         LED current (default: 5)\n"
+          "  -x mA         transmitter current while enabled (default: 0)\n",
+          name);
+}
+
+
+/*===========================================================================*/
+/*  Function: print_setting                                                  */
+/*  Module:   foxenergy                                                      */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - index: setting, the interval mode, length, speed and code bits   */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the switch settings, and the foxes of the interval mode         */
+/*===========================================================================*/
+static void print_setting(int index)
+{
+  static const char *const codes[DIP_CODE_MSG] = CODE_NAMES;
+  static const uint8_t foxes[] = DIP_INTERVAL_FOXES;
+  int code = index % (DIP_CODE_MSG + 1);
+
+  index /= DIP_CODE_MSG + 1;
+  printf("%s %s %s interval %d", code < DIP_CODE_MSG ? codes[code] : "MSG",
+         index & 1 ? "fast" : "slow", (index >> 1) & 1 ? "short" : "long", index >> 2);
+  if (foxes[index >> 2])
+    printf(" (%d foxes)", foxes[index >> 2]);
+  else
+    printf(" (continuous)");
+}
+
+
+/*===========================================================================*/
+/*  Function: trace_output                                                   */
+/*  Module:   foxenergy                                                      */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - out: output pin levels                                           */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    sums the time the LED and the enable output were on, up to the change  */
+/*===========================================================================*/
+static void trace_output(const SIM_OUTPUT *out)
+{
+  if (trace_led)
+    trace_setting->led += out->time - trace_time;
+  if (trace_enable)
+    trace_setting->enable += out->time - trace_time;
+
+  trace_time = out->time;
+  trace_led = out->led == SIM_PIN_HIGH;
+  trace_enable = out->enable == SIM_PIN_HIGH;
+}
+
+
+/*===========================================================================*/
+/*  Function: run_setting                                                    */
+/*  Module:   foxenergy                                                      */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - index: setting, the interval mode, length, speed and code bits   */
+/*        - setting: results                                                 */
+/*        - cycles: simulated time                                           */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    simulates a setting, the child process runs it on a fresh copy of the  */
+/*    firmware variables, as after a reset                                   */
+/*    the key and enable outputs are set to active high, the frequency to 0  */
+/*===========================================================================*/
+static void run_setting(int index, SETTING *setting, uint64_t cycles)
+{
+  SIM_DIP dip = { 0, 0, 0, 0, 1, 1, 0 };
+  SIM_RESULT res;
+
+  dip.code = index % (DIP_CODE_MSG + 1);
+  index /= DIP_CODE_MSG + 1;
+  dip.speed = index & 1;
+  dip.interval_length = (index >> 1) & 1;
+  dip.interval = index >> 2;
+
+  sim_reset();
+  if (sim_set_dip(&dip))
+  {
+    setting->state = SETTING_CONFLICT;
+    return;
+  }
+
+  trace_setting = setting;
+  res = sim_run(cycles, trace_output);
+  if (res != SIM_DONE)
+  {
+    setting->state = SETTING_FAILED;
+    return;
+  }
+
+  // the levels after the last change hold until the end
+  trace_output(&(SIM_OUTPUT){ cycles, 0, 0, 0 });
+  setting->irqs = sim_irq_count;
+  setting->power_down = sim_power_down_time;
+  setting->pullup = sim_pullup_time;
+  setting->state = SETTING_DONE;
+}
+
+
+/*===========================================================================*/
+/*  Function: estimate                                                       */
+/*  Module:   foxenergy                                                      */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - setting: results of the setting                                  */
+/*        - cycles: simulated time                                           */
+/*        - wake_cycles: MCU cycles of an interrupt                          */
+/*        - led_ma: LED current                                              */
+/*        - tx_ma: transmitter current                                       */
+/*        - charge: charge drawn by the parts                                */
+/*  Return value:                                                            */
+/*        - total charge in mAh                                              */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the MCU is active for wake_cycles of the system clock at every         */
+/*    interrupt, and sleeps in idle for the rest of the time it is not       */
+/*    powered down, the active and idle currents scale with the clock        */
+/*===========================================================================*/
+static double estimate(const SETTING *setting, uint64_t cycles, double wake_cycles,
+                       double led_ma, double tx_ma, CHARGE *charge)
+{
+  double mhz = F_CLK / 1e6;
+  double awake = (double)(cycles - setting->power_down) / F_CPU;
+  double active = setting->irqs * wake_cycles / F_CLK;
+
+  if (active > awake)
+    active = awake;
+
+  charge->mcu = active * ACTIVE_UA_PER_MHZ * mhz +
+                (awake - active) * IDLE_UA_PER_MHZ * mhz +
+                (double)setting->power_down / F_CPU * POWER_DOWN_UA;
+  charge->led = (double)setting->led / F_CPU * led_ma * 1000;
+  charge->pullup = (double)setting->pullup / F_CPU * PULLUP_UA;
+  charge->tx = (double)setting->enable / F_CPU * tx_ma * 1000;
+
+  return (charge->mcu + charge->led + charge->pullup + charge->tx) / 3.6e6;
+}
+
+
+/**** global functions *******************************************************/
+
+/*===========================================================================*/
+/*  Function: main                                                           */
+/*  Module:   foxenergy                                                      */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - argc, argv: command line                                         */
+/*  Return value:                                                            */
+/*        - exit status                                                      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    simulates every setting of the DIP switches in child processes, and    */
+/*    prints the charge drawn by them in the event, the highest at the end   */
+/*===========================================================================*/
+int main(int argc, char *argv[])
+{
+  SETTING *settings;
+  CHARGE charge;
+  double hours = 3;
+  double wake_cycles = 100;
+  double led_ma = 5;
+  double tx_ma = 0;
+  double mah, worst = 0;
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  uint64_t cycles;
+  int running = 0;
+  int failed = 0;
+  int worst_index = -1;
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "t:j:c:L:x:h")) != -1)
+  {
+    switch (opt)
+    {
+      case 't': hours = strtod(optarg, NULL); break;
+      case 'j': jobs = strtol(optarg, NULL, 0); break;
+      case 'c': wake_cycles = strtod(optarg, NULL); break;
+      case 'L': led_ma = strtod(optarg, NULL); break;
+      case 'x': tx_ma = strtod(optarg, NULL); break;
+      default: usage(argv[0]); return 2;
+    }
+  }
+  if (jobs < 1)
+    jobs = 1;
+  cycles = (uint64_t)(hours * 3600 * F_CPU);
+
+  settings = mmap(NULL, MAX_SETTINGS * sizeof(SETTING), PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (settings == MAP_FAILED)
+  {
+    perror("mmap");
+    return 1;
+  }
+
+  // every setting in a child process, at most jobs at the same time
+  for (i = 0; i < MAX_SETTINGS; i++)
+  {
+    pid_t pid;
+
+    if (running == jobs)
+    {
+      wait(NULL);
+      running--;
+    }
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0)
+    {
+      perror("fork");
+      return 1;
+    }
+    if (!pid)
+    {
+      run_setting(i, &settings[i], cycles);
+      _exit(0);
+    }
+    running++;
+  }
+  while (running--)
+    wait(NULL);
+
+  printf("%.1f hours, MCU at %.3f MHz: active %.0f uA/MHz for %.0f cycles an interrupt, "
+         "idle %.0f uA/MHz, power-down %.1f uA, pull-up %.0f uA, LED %.1f mA, "
+         "transmitter %.1f mA\n",
+         hours, F_CLK / 1e6, ACTIVE_UA_PER_MHZ, wake_cycles, IDLE_UA_PER_MHZ,
+         POWER_DOWN_UA, PULLUP_UA, led_ma, tx_ma);
+
+  for (i = 0; i < MAX_SETTINGS; i++)
+  {
+    const SETTING *setting = &settings[i];
+
+    print_setting(i);
+    printf(": ");
+
+    if (setting->state == SETTING_CONFLICT)
+    {
+      printf("not settable on this board\n");
+      continue;
+    }
+    if (setting->state != SETTING_DONE)
+    {
+      printf("simulation failed\n");
+      failed++;
+      continue;
+    }
+
+    mah = estimate(setting, cycles, wake_cycles, led_ma, tx_ma, &charge);
+    printf("enable %.1f%%, LED %.2f%%, power-down %.1f%%, %.1f wake-ups/s, "
+           "%.3f mAh (MCU %.3f, LED %.3f, pull-ups %.3f, transmitter %.3f)\n",
+           100.0 * setting->enable / cycles, 100.0 * setting->led / cycles,
+           100.0 * setting->power_down / cycles, setting->irqs / (hours * 3600),
+           mah, charge.mcu / 3.6e6, charge.led / 3.6e6, charge.pullup / 3.6e6,
+           charge.tx / 3.6e6);
+    if (mah > worst)
+    {
+      worst = mah;
+      worst_index = i;
+    }
+  }
+
+  if (worst_index >= 0)
+  {
+    printf("highest: ");
+    print_setting(worst_index);
+    printf(", %.3f mAh, %.3f mA on average\n", worst, worst / hours);
+  }
+
+  return failed ? 1 : 0;
+}
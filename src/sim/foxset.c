@@ -0,0 +1,726 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: foxset.c                                                        */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - verifier of the fox sets on the host simulator                        */
+/*     simulates every fox of every set (code speed, interval length and     */
+/*     interval mode of the DIP switches) for hours, and checks that the     */
+/*     transmit windows of a set never overlap, every window holds whole     */
+/*     words followed by the TXOFF tone, and the windows do not drift        */
+/*     the simulator state is global, so every fox runs in its own process,  */
+/*     as many in parallel as there are processors                           */
+/*     with a sync pulse the foxes are powered on one after the other, the   */
+/*     pulse shall align them, only the windows after it are checked         */
+/*     the codes MO, S and the message, which key in the window of MOE, are  */
+/*     checked alone for whole words, the TXOFF tone and drift, and in       */
+/*     continuous keying every code alone for whole words                    */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - first implementation                                      */
+/*                                                                           */
+/*****************************************************************************/
+
+/**** include files **********************************************************/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "sim.h"
+#include "config.h"
+
+/**** constants **************************************************************/
+
+// most foxes of a set, the codes MOE ... MO5
+#define MAX_FOXES 5
+
+// transmit windows recorded for a fox
+#define MAX_WINDOWS 8192
+
+// most sets: code speed, interval length and interval mode switches, a set
+// or a single fox of every code
+#define MAX_SETS (2 * 2 * (1 << DIP_INTERVAL_BITS) * (DIP_CODE_MSG + 1))
+
+// clock source cycles of a tick and of a sign
+#define TICK_CYCLES ((uint64_t)F_CPU / TICKS_PER_SECOND)
+#define SIGN_CYCLES(wpm) ((uint64_t)F_CPU * SIGN_TICKS_NUM / TICKS_PER_SECOND / SIGN_TICKS_DEN(wpm))
+
+// a silence of this many signs separates words, a letter space is 3 and a
+// word space at least 7
+#define WORD_GAP_SIGNS 5
+
+// with a sync pulse the foxes of a set are powered on this far apart, a
+// few seconds and a fraction of a tick
+#define POWER_ON_CYCLES ((uint64_t)F_CPU * 2 + TICK_CYCLES * 3 / 7)
+
+// state of a simulated fox
+#define FOX_NEW 0
+#define FOX_DONE 1
+#define FOX_CONFLICT 2
+
+/**** local types ************************************************************/
+
+// fox set: one DIP switch setting, the foxes differ only in the code, the
+// count foxes from code are simulated: the whole set, or a single fox
+typedef struct
+{
+  uint8_t speed;
+  uint8_t length;
+  uint8_t interval;
+  uint8_t code;
+  int foxes;
+  int count;
+  int first;
+} FOX_SET;
+
+// simulated fox, in memory shared with the parent process
+typedef struct
+{
+  int state;
+  int windows;
+  int words;
+  int word_marks;
+  int errors;
+  char error[128];
+  uint64_t start[MAX_WINDOWS];
+  uint64_t end[MAX_WINDOWS];
+} FOX;
+
+/**** local function prototypes **********************************************/
+static void usage(const char *name);
+static int set_size(uint8_t value);
+static void add_set(FOX_SET *set, uint8_t code, int count, int *total);
+static void fox_error(const char *fmt, ...);
+static void end_word(void);
+static void trace_output(const SIM_OUTPUT *out);
+static void run_fox(const FOX_SET *set, int pos, FOX *fox, uint64_t cycles,
+                    uint64_t sync);
+static int compare_time(const void *a, const void *b);
+static int verify_set(const FOX_SET *set, FOX *foxes, uint64_t drift_max,
+                      uint64_t overlap_max, uint64_t sync);
+
+/**** local variables ********************************************************/
+
+// fox being simulated by the process, and the state of its checks
+static FOX *trace_fox;
+static uint64_t trace_sign;
+static int trace_key;
+static int trace_enable;
+static uint64_t trace_key_on;
+static uint64_t trace_key_off;
+static int trace_marks;
+static int trace_words;
+static uint64_t trace_power_on;
+static uint64_t trace_sync;
+static int trace_continuous;
+static int trace_window;
+static uint64_t trace_mark;
+
+/**** local functions ********************************************************/
+
+/*===========================================================================*/
+/*  Function: usage                                                          */
+/*  Module:   foxset                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - name: program name                                               */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the command line help                                           */
+/*===========================================================================*/
+static void usage(const char *name)
+{
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  -t hours      simulated time (default: 10)\n"
+          "  -j jobs       foxes simulated in parallel (default: processors)\n"
+          "  -d ms         allowed drift of the windows (default: 10)\n"
+          "  -o ms         allowed overlap of the windows (default: 4)\n"
+          "  -w percent    watchdog oscillator error (default: 0)\n"
+          "  -S seconds    sync pulse at this time, the foxes powered on before\n"
+          "the sets MOE, MOI, ... of every interval mode are checked as a whole,\n"
+          "the codes MO, S and MSG alone, and in continuous keying every code\n"
+          "alone for whole words only\n",
+          name);
+}
+
+
+/*===========================================================================*/
+/*  Function: set_size                                                       */
+/*  Module:   foxset                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - value: interval mode, as read from the DIP switches              */
+/*  Return value:                                                            */
+/*        - number of foxes in the set, 0 for continuous keying              */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the interval is a whole number of enable periods, one for every fox,   */
+/*    as given by the same table of config.h the firmware is built with      */
+/*===========================================================================*/
+static int set_size(uint8_t value)
+{
+  static const uint8_t foxes[] = DIP_INTERVAL_FOXES;
+
+  return foxes[value];
+}
+
+
+/*===========================================================================*/
+/*  Function: add_set                                                        */
+/*  Module:   foxset                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - set: fox set, its switch settings already filled in              */
+/*        - code: code of the first fox simulated                            */
+/*        - count: number of foxes simulated                                 */
+/*        - total: foxes of the sets so far                                  */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    takes the foxes of the set from the results of all foxes               */
+/*===========================================================================*/
+static void add_set(FOX_SET *set, uint8_t code, int count, int *total)
+{
+  set->code = code;
+  set->count = count;
+  set->first = *total;
+  *total += count;
+}
+
+
+/*===========================================================================*/
+/*  Function: fox_error                                                      */
+/*  Module:   foxset                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - fmt, ...: message                                                */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    counts a failed check of the simulated fox, the first one is kept      */
+/*    with the simulated time                                                */
+/*===========================================================================*/
+static void fox_error(const char *fmt, ...)
+{
+  va_list ap;
+  int len;
+
+  if (!trace_fox->errors++)
+  {
+    len = snprintf(trace_fox->error, sizeof(trace_fox->error), "%.3f s: ",
+                   (double)sim_time / F_CPU);
+    va_start(ap, fmt);
+    vsnprintf(trace_fox->error + len, sizeof(trace_fox->error) - len, fmt, ap);
+    va_end(ap);
+  }
+}
+
+
+/*===========================================================================*/
+/*  Function: end_word                                                       */
+/*  Module:   foxset                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    checks the marks of a word, every word has as many as the first one    */
+/*    the words are counted for the continuous keying, which has no windows  */
+/*===========================================================================*/
+static void end_word(void)
+{
+  if (!trace_fox->word_marks)
+    trace_fox->word_marks = trace_marks;
+  else if (trace_marks != trace_fox->word_marks)
+    fox_error("partial word, %d of %d marks", trace_marks, trace_fox->word_marks);
+
+  trace_marks = 0;
+  trace_words++;
+  trace_fox->words++;
+}
+
+
+/*===========================================================================*/
+/*  Function: trace_output                                                   */
+/*  Module:   foxset                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - out: output pin levels                                           */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    records the transmit windows, and checks their content as the edges    */
+/*    come: the marks are counted by words, a long enough silence between    */
+/*    two marks ends a word, the mark still on at the end of the window is   */
+/*    the TXOFF tone, which follows the last word after a word space         */
+/*    the key is only keyed in the windows                                   */
+/*    in continuous keying the enable stays on, only the words are checked   */
+/*    a board without enable output (LTC6903) keeps the oscillator on, its   */
+/*    window is taken from the key: from the first mark to the end of the    */
+/*    TXOFF tone, the longest mark, so keying outside of it is not seen      */
+/*    the times are counted from the power-on of the first fox of the set,   */
+/*    with a sync pulse the edges up to it are not checked                   */
+/*===========================================================================*/
+static void trace_output(const SIM_OUTPUT *out)
+{
+  int key = out->key == SIM_PIN_HIGH;
+  int enable = out->enable == SIM_PIN_HIGH;
+  uint64_t time = out->time + trace_power_on;
+  uint64_t txoff;
+
+  if (out->enable == SIM_PIN_NC)
+  {
+    if (trace_continuous || (key && !trace_key))
+      trace_window = 1;
+    else if (!key && trace_key && time - trace_mark + TICK_CYCLES >= TXOFF_TICKS * TICK_CYCLES)
+      trace_window = 0;
+    if (key && !trace_key)
+      trace_mark = time;
+    enable = trace_window;
+  }
+
+  if (time <= trace_sync)
+  {
+    trace_key = key;
+    trace_enable = enable;
+    return;
+  }
+
+  if (enable && !trace_enable)
+  {
+    // start of a window
+    if (trace_fox->windows < MAX_WINDOWS)
+      trace_fox->start[trace_fox->windows] = time;
+    trace_key_off = time;
+    trace_marks = 0;
+    trace_words = 0;
+  }
+
+  if (enable && key != trace_key)
+  {
+    if (key)
+    {
+      if (trace_marks && time - trace_key_off >= WORD_GAP_SIGNS * trace_sign)
+        end_word();
+      trace_key_on = time;
+    }
+    else
+    {
+      trace_marks++;
+      trace_key_off = time;
+    }
+  }
+  else if (!enable && trace_enable)
+  {
+    // end of a window, the key is released with the enable
+    txoff = time - trace_key_on;
+    if (!trace_key)
+      fox_error("no TXOFF tone");
+    else if (txoff + TICK_CYCLES < TXOFF_TICKS * TICK_CYCLES ||
+             txoff > TXOFF_TICKS * TICK_CYCLES + TICK_CYCLES)
+      fox_error("TXOFF tone of %.3f s", (double)txoff / F_CPU);
+    else if (trace_key_on - trace_key_off < WORD_GAP_SIGNS * trace_sign)
+      fox_error("no word space before the TXOFF tone");
+    if (trace_marks)
+      end_word();
+    if (!trace_words)
+      fox_error("no whole word in the window");
+
+    if (trace_fox->windows < MAX_WINDOWS)
+      trace_fox->end[trace_fox->windows] = time;
+    else if (trace_fox->windows == MAX_WINDOWS)
+      fox_error("more than %d windows, not recorded", MAX_WINDOWS);
+    trace_fox->windows++;
+  }
+  else if (!enable && key && !trace_key)
+  {
+    fox_error("keyed outside of the window");
+  }
+
+  trace_key = key;
+  trace_enable = enable;
+}
+
+
+/*===========================================================================*/
+/*  Function: run_fox                                                        */
+/*  Module:   foxset                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - set: fox set                                                     */
+/*        - pos: position of the fox in the simulated foxes of the set       */
+/*        - fox: results                                                     */
+/*        - cycles: simulated time                                           */
+/*        - sync: time of the sync pulse, 0 if none                          */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    simulates a fox of the set, the child process runs it on a fresh copy  */
+/*    of the firmware variables, as after a reset                            */
+/*    the key and enable outputs are set to active high                      */
+/*    with a sync pulse the fox is powered on POWER_ON_CYCLES after the one  */
+/*    before it in the set, and runs until the same time                     */
+/*===========================================================================*/
+static void run_fox(const FOX_SET *set, int pos, FOX *fox, uint64_t cycles,
+                    uint64_t sync)
+{
+  SIM_DIP dip = { 0, 0, 0, 0, 1, 1, 0 };
+  SIM_RESULT res;
+
+  dip.code = set->code + pos;
+  dip.speed = set->speed;
+  dip.interval_length = set->length;
+  dip.interval = set->interval;
+
+  sim_reset();
+  if (sim_set_dip(&dip))
+  {
+    fox->state = FOX_CONFLICT;
+    return;
+  }
+
+  if (sync)
+  {
+    trace_power_on = pos * POWER_ON_CYCLES;
+    trace_sync = sync;
+    sim_sync(sync - trace_power_on);
+  }
+
+  trace_fox = fox;
+  trace_continuous = !set->foxes;
+  trace_sign = SIGN_CYCLES(set->speed ? CODE_SPEED_FAST : CODE_SPEED_SLOW);
+  res = sim_run(cycles - trace_power_on, trace_output);
+  if (res != SIM_DONE)
+    fox_error("firmware %s", res == SIM_HALTED ? "halted" : "returned from main()");
+  if (fox->windows > MAX_WINDOWS)
+    fox->windows = MAX_WINDOWS;
+
+  fox->state = FOX_DONE;
+}
+
+
+/*===========================================================================*/
+/*  Function: compare_time                                                   */
+/*  Module:   foxset                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - a, b: start and end of two windows                               */
+/*  Return value:                                                            */
+/*        - order of the windows                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    orders the windows by start time, for qsort()                          */
+/*===========================================================================*/
+static int compare_time(const void *a, const void *b)
+{
+  const uint64_t *wa = a;
+  const uint64_t *wb = b;
+
+  return wa[0] < wb[0] ? -1 : wa[0] > wb[0];
+}
+
+
+/*===========================================================================*/
+/*  Function: verify_set                                                     */
+/*  Module:   foxset                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - set: fox set                                                     */
+/*        - foxes: results of the foxes of the set                           */
+/*        - drift_max: allowed drift of the windows                          */
+/*        - overlap_max: allowed overlap of the windows                      */
+/*        - sync: time of the sync pulse, 0 if none                          */
+/*  Return value:                                                            */
+/*        - number of failed checks                                          */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the checks of the foxes, and checks the set as a whole: every   */
+/*    window starts and ends where it should, the n-th window of a fox       */
+/*    starts n intervals and its position times the enable period after the  */
+/*    first window of the first fox, or a tick after the sync pulse, and the */
+/*    windows do not overlap                                                 */
+/*    a single fox of the codes keying in the window of MOE is checked the   */
+/*    same way, in continuous keying only its words are checked              */
+/*    the windows of a set follow each other without a gap, so the phase     */
+/*    error of the watchdog timed off-periods makes them overlap a little,   */
+/*    a small overlap is allowed, less than the tick a misaligned set is off */
+/*===========================================================================*/
+static int verify_set(const FOX_SET *set, FOX *foxes, uint64_t drift_max,
+                      uint64_t overlap_max, uint64_t sync)
+{
+  static uint64_t windows[MAX_FOXES * MAX_WINDOWS][2];
+  static const char *const codes[] = { "MO", "MOE", "MOI", "MOS", "MOH", "MO5", "S", "MSG" };
+  uint64_t period = TICK_CYCLES * INTERVAL_COUNT(set->length ? INTERVAL_SHORT : INTERVAL_LONG);
+  uint64_t interval = period * set->foxes;
+  uint64_t base;
+  uint64_t drift = 0;
+  int count = 0;
+  int failed = 0;
+  uint64_t overlap = 0;
+  int f, w;
+
+  if (set->count == 1)
+    printf("code %s, ", codes[set->code]);
+  printf("speed %d (%d WPM), length %d (%d s), interval %d ",
+         set->speed, set->speed ? CODE_SPEED_FAST : CODE_SPEED_SLOW,
+         set->length, set->length ? INTERVAL_SHORT : INTERVAL_LONG,
+         set->interval);
+  if (set->foxes)
+    printf("(%d foxes): ", set->foxes);
+  else
+    printf("(continuous): ");
+
+  for (f = 0; f < set->count; f++)
+  {
+    if (foxes[f].state == FOX_CONFLICT)
+    {
+      printf("not settable on this board\n");
+      return 0;
+    }
+  }
+
+  if (!set->foxes)
+  {
+    printf("%d words\n", foxes[0].words);
+    if (foxes[0].state != FOX_DONE)
+    {
+      printf("  simulation failed\n");
+      return 1;
+    }
+    if (foxes[0].errors)
+    {
+      printf("  %d error(s), first at %s\n", foxes[0].errors, foxes[0].error);
+      return 1;
+    }
+    if (!foxes[0].words)
+    {
+      printf("  no whole word\n");
+      return 1;
+    }
+    return 0;
+  }
+
+  if (sync)
+    base = sync + TICK_CYCLES;
+  else
+    base = foxes[0].windows ? foxes[0].start[0] : 0;
+  for (f = 0; f < set->count; f++)
+  {
+    for (w = 0; w < foxes[f].windows; w++)
+    {
+      uint64_t ideal = base + f * period + w * interval;
+      uint64_t start = foxes[f].start[w];
+      uint64_t end = foxes[f].end[w];
+
+      if (start > ideal + drift || ideal > start + drift)
+        drift = start > ideal ? start - ideal : ideal - start;
+      if (end > ideal + period + drift || ideal + period > end + drift)
+        drift = end > ideal + period ? end - ideal - period : ideal + period - end;
+
+      windows[count][0] = start;
+      windows[count][1] = end;
+      count++;
+    }
+  }
+
+  qsort(windows, count, sizeof(windows[0]), compare_time);
+  for (w = 1; w < count; w++)
+    if (windows[w][0] + overlap < windows[w - 1][1])
+      overlap = windows[w - 1][1] - windows[w][0];
+
+  printf("%d windows, drift %.3f ms, overlap %.3f ms\n", count,
+         drift * 1000.0 / F_CPU, overlap * 1000.0 / F_CPU);
+
+  for (f = 0; f < set->count; f++)
+  {
+    if (foxes[f].state != FOX_DONE)
+    {
+      printf("  fox %d: simulation failed\n", f + 1);
+      failed++;
+    }
+    else if (foxes[f].errors)
+    {
+      printf("  fox %d: %d error(s), first at %s\n", f + 1, foxes[f].errors, foxes[f].error);
+      failed++;
+    }
+    else if (!foxes[f].windows)
+    {
+      printf("  fox %d: no transmit window\n", f + 1);
+      failed++;
+    }
+  }
+  if (drift > drift_max)
+  {
+    printf("  drift over %.3f ms\n", drift_max * 1000.0 / F_CPU);
+    failed++;
+  }
+  if (overlap > overlap_max)
+  {
+    printf("  overlap over %.3f ms\n", overlap_max * 1000.0 / F_CPU);
+    failed++;
+  }
+
+  return failed;
+}
+
+
+/**** global functions *******************************************************/
+
+/*===========================================================================*/
+/*  Function: main                                                           */
+/*  Module:   foxset                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - argc, argv: command line                                         */
+/*  Return value:                                                            */
+/*        - exit status                                                      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    lists the sets of the DIP switches, simulates their foxes in child     */
+/*    processes, and verifies the sets when all of them are done             */
+/*===========================================================================*/
+int main(int argc, char *argv[])
+{
+  FOX_SET sets[MAX_SETS];
+  FOX *foxes;
+  double hours = 10;
+  double drift_ms = 10;
+  double overlap_ms = 4;
+  double sync_s = 0;
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  uint64_t cycles;
+  uint64_t sync;
+  int count = 0;
+  int total = 0;
+  int running = 0;
+  int failed = 0;
+  int opt;
+  int s, f;
+  uint8_t code;
+
+  while ((opt = getopt(argc, argv, "t:j:d:o:w:S:h")) != -1)
+  {
+    switch (opt)
+    {
+      case 't': hours = strtod(optarg, NULL); break;
+      case 'j': jobs = strtol(optarg, NULL, 0); break;
+      case 'd': drift_ms = strtod(optarg, NULL); break;
+      case 'o': overlap_ms = strtod(optarg, NULL); break;
+      case 'w': sim_wdt_freq = SIM_WDT_FREQ * (1 + strtod(optarg, NULL) / 100); break;
+      case 'S': sync_s = strtod(optarg, NULL); break;
+      default: usage(argv[0]); return 2;
+    }
+  }
+  if (jobs < 1)
+    jobs = 1;
+  cycles = (uint64_t)(hours * 3600 * F_CPU);
+  sync = (uint64_t)(sync_s * F_CPU);
+  if (sync && (sync <= (MAX_FOXES - 1) * POWER_ON_CYCLES || sync >= cycles))
+  {
+    fprintf(stderr, "%s: the sync pulse shall come after %.3f s, in the simulated time\n",
+            argv[0], (double)(MAX_FOXES - 1) * POWER_ON_CYCLES / F_CPU);
+    return 2;
+  }
+
+  // sets of every interval mode, the codes keying in the window of MOE
+  // alone, and every code alone in continuous keying
+  for (s = 0; s < 2 * 2 * (1 << DIP_INTERVAL_BITS); s++)
+  {
+    FOX_SET set;
+
+    set.speed = s & 1;
+    set.length = (s >> 1) & 1;
+    set.interval = s >> 2;
+    set.foxes = set_size(set.interval);
+    if (set.foxes > MAX_FOXES)
+      continue;
+    if (set.foxes)
+    {
+      sets[count] = set;
+      add_set(&sets[count++], DIP_CODE_MOE, set.foxes, &total);
+    }
+    for (code = DIP_CODE_MO; code <= DIP_CODE_MSG; code++)
+    {
+#ifdef USE_CALIBRATE
+      // no keying, the clock is calibrated
+      if (code == CAL_CODE)
+        continue;
+#endif
+      if (set.foxes && code >= DIP_CODE_MOE && code <= DIP_CODE_MO5)
+        continue;
+      sets[count] = set;
+      add_set(&sets[count++], code, 1, &total);
+    }
+  }
+
+  foxes = mmap(NULL, total * sizeof(FOX), PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (foxes == MAP_FAILED)
+  {
+    perror("mmap");
+    return 1;
+  }
+
+  // every fox in a child process, at most jobs at the same time
+  for (s = 0; s < count; s++)
+  {
+    for (f = 0; f < sets[s].count; f++)
+    {
+      pid_t pid;
+
+      if (running == jobs)
+      {
+        wait(NULL);
+        running--;
+      }
+
+      fflush(stdout);
+      pid = fork();
+      if (pid < 0)
+      {
+        perror("fork");
+        return 1;
+      }
+      if (!pid)
+      {
+        run_fox(&sets[s], f, &foxes[sets[s].first + f], cycles, sync);
+        _exit(0);
+      }
+      running++;
+    }
+  }
+  while (running--)
+    wait(NULL);
+
+  for (s = 0; s < count; s++)
+    failed += verify_set(&sets[s], &foxes[sets[s].first],
+                         (uint64_t)(drift_ms * F_CPU / 1000),
+                         (uint64_t)(overlap_ms * F_CPU / 1000), sync);
+
+  printf("%d set(s), %d fox(es), %.1f hours: %s\n", count, total, hours,
+         failed ? "FAILED" : "ok");
+
+  return failed ? 1 : 0;
+}
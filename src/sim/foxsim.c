@@ -0,0 +1,286 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: foxsim.c                                                        */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - host simulator of the ARDF controller                                 */
+/*     runs the firmware for the selected DIP switch settings and prints the */
+/*     KEY/ENABLE/LED timeline, or measures the simulation speed             */
+/*     the switches can be changed once during the run, the controller reset */
+/*     by a brown-out, and a reference pulse train given for the calibration */
+/*     the supply measured by the ADC can be set, and drop with the time     */
+/*     the telemetry records sent on the UART line are printed between the   */
+/*     timeline lines                                                        */
+/*     a sync pulse can be given, the offset of the ticks from it is printed */
+/*     with the statistics                                                   */
+/*     the EEPROM can be saved at the end, for the host decoder of the trace */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - first implementation                                      */
+/*                                                                           */
+/*****************************************************************************/
+
+/**** include files **********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim.h"
+#include "tools/telemetry.h"
+
+/**** local function prototypes **********************************************/
+static void usage(const char *name);
+static void print_output(const SIM_OUTPUT *out);
+static void print_telemetry(uint8_t byte);
+
+/**** external variables *****************************************************/
+
+#ifdef USE_TRACE
+// EEPROM trace log of the firmware, only its address is used
+extern uint8_t trace_log[];
+#endif
+
+/**** constants **************************************************************/
+
+static const char pin_char[4] = { '0', '1', 'z', '-' };
+
+/**** local variables ********************************************************/
+
+static TLM_DECODER decoder;
+
+/**** local functions ********************************************************/
+
+/*===========================================================================*/
+/*  Function: usage                                                          */
+/*  Module:   foxsim                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - name: program name                                               */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the command line help                                           */
+/*===========================================================================*/
+static void usage(const char *name)
+{
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  DIP switch values, as read by the firmware (0 = closed):\n"
+          "  -c code       code (0: MO, 1: MOE, ... 5: MO5, 6: S)\n"
+          "  -s speed      code speed (0: slow, 1: fast)\n"
+          "  -l length     interval length (0: long, 1: short)\n"
+          "  -i interval   interval mode\n"
+          "  -k level      key level\n"
+          "  -e level      enable level\n"
+          "  -f freq       frequency\n"
+          "  -T seconds    change the switches given after it at this time\n"
+          "  simulation:\n"
+          "  -t seconds    simulated time (default: 300)\n"
+          "  -R seconds    brown-out reset at this time\n"
+          "  -P ppm        1PPS reference on PA4, the clock is fast by ppm\n"
+          "  -S seconds    sync pulse at this time\n"
+          "  -w percent    watchdog oscillator error (default: 0)\n"
+          "  -V mV         supply voltage (default: %d)\n"
+          "  -D mV         supply drop in an hour (default: 0)\n"
+          "  -E file       save the EEPROM at the end, in Intel HEX\n"
+          "  -q            do not print the timeline\n"
+          "  -b            print simulation statistics\n",
+          name, SIM_BATTERY_MV);
+}
+
+
+/*===========================================================================*/
+/*  Function: print_output                                                   */
+/*  Module:   foxsim                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - out: output pin levels                                           */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints a timeline line: time in milliseconds, KEY, ENABLE and LED      */
+/*    levels, z for an input pin and - for a pin not used by the board       */
+/*===========================================================================*/
+static void print_output(const SIM_OUTPUT *out)
+{
+  uint64_t us = out->time * 1000000 / F_CPU;
+
+  printf("%llu.%03llu %c %c %c\n",
+         (unsigned long long)(us / 1000), (unsigned long long)(us % 1000),
+         pin_char[out->key], pin_char[out->enable], pin_char[out->led]);
+}
+
+
+/*===========================================================================*/
+/*  Function: print_telemetry                                                */
+/*  Module:   foxsim                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - byte: byte sent on the UART line                                 */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints a telemetry record, when it is complete, after the time in      */
+/*    milliseconds and a #, as the host decoder does                         */
+/*===========================================================================*/
+static void print_telemetry(uint8_t byte)
+{
+  uint64_t us = sim_time * 1000000 / F_CPU;
+
+  if (!tlm_decode(&decoder, byte))
+    return;
+
+  printf("%llu.%03llu # ", (unsigned long long)(us / 1000), (unsigned long long)(us % 1000));
+  tlm_print(&decoder, stdout);
+}
+
+
+/**** global functions *******************************************************/
+
+/*===========================================================================*/
+/*  Function: main                                                           */
+/*  Module:   foxsim                                                         */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - argc, argv: command line                                         */
+/*  Return value:                                                            */
+/*        - exit status                                                      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    parses the command line and runs the simulation                        */
+/*===========================================================================*/
+int main(int argc, char *argv[])
+{
+  SIM_DIP dip = { 0, 0, 0, 0, 0, 0, 0 };
+  SIM_DIP changed;
+  SIM_DIP *set = &dip;
+  double change = -1;
+  double brown_out = -1;
+  double reference = 0;
+  int ref = 0;
+  double sync = -1;
+  double battery = SIM_BATTERY_MV;
+  double drop = 0;
+  double seconds = 300;
+  const char *eeprom = NULL;
+  int quiet = 0;
+  int stats = 0;
+  int opt;
+  clock_t start;
+  double wall;
+  SIM_RESULT res;
+
+  while ((opt = getopt(argc, argv, "c:s:l:i:k:e:f:T:R:P:S:t:w:V:D:E:qbh")) != -1)
+  {
+    switch (opt)
+    {
+      case 'c': set->code = (uint8_t)strtoul(optarg, NULL, 0); break;
+      case 's': set->speed = (uint8_t)strtoul(optarg, NULL, 0); break;
+      case 'l': set->interval_length = (uint8_t)strtoul(optarg, NULL, 0); break;
+      case 'i': set->interval = (uint8_t)strtoul(optarg, NULL, 0); break;
+      case 'k': set->key_level = (uint8_t)strtoul(optarg, NULL, 0); break;
+      case 'e': set->enable_level = (uint8_t)strtoul(optarg, NULL, 0); break;
+      case 'f': set->freq = (uint8_t)strtoul(optarg, NULL, 0); break;
+      case 'T':
+        // the switches given after the time are changed then
+        change = strtod(optarg, NULL);
+        changed = dip;
+        set = &changed;
+        break;
+      case 'P': reference = strtod(optarg, NULL); ref = 1; break;
+      case 'R': brown_out = strtod(optarg, NULL); break;
+      case 'S': sync = strtod(optarg, NULL); break;
+      case 't': seconds = strtod(optarg, NULL); break;
+      case 'w': sim_wdt_freq = SIM_WDT_FREQ * (1 + strtod(optarg, NULL) / 100); break;
+      case 'V': battery = strtod(optarg, NULL); break;
+      case 'D': drop = strtod(optarg, NULL); break;
+      case 'E': eeprom = optarg; break;
+      case 'q': quiet = 1; break;
+      case 'b': stats = 1; break;
+      default: usage(argv[0]); return 2;
+    }
+  }
+
+  sim_reset();
+  if (sim_set_dip(&dip))
+  {
+    fprintf(stderr, "%s: conflicting settings on shared DIP switches\n", argv[0]);
+    return 2;
+  }
+  if (change >= 0 && sim_change_dip((uint64_t)(change * F_CPU), &changed))
+  {
+    fprintf(stderr, "%s: conflicting settings on shared DIP switches\n", argv[0]);
+    return 2;
+  }
+
+  if (brown_out >= 0)
+    sim_brown_out((uint64_t)(brown_out * F_CPU));
+  // the reference is disconnected when the switches are changed
+  if (ref)
+    sim_reference(F_CPU / 2, (uint64_t)(F_CPU * (1 + reference / 1e6) + 0.5),
+                  change >= 0 ? (uint64_t)(change * F_CPU) : UINT64_MAX);
+  if (sync >= 0)
+    sim_sync((uint64_t)(sync * F_CPU));
+  sim_battery(battery, drop);
+  sim_uart(quiet ? NULL : print_telemetry);
+
+  start = clock();
+  res = sim_run((uint64_t)(seconds * F_CPU), quiet ? NULL : print_output);
+  wall = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  if (stats)
+  {
+    fprintf(stderr, "simulated %.3f s in %.3f s, %lu interrupts, %.2f M interrupts/s\n",
+            (double)sim_time / F_CPU, wall, (unsigned long)sim_irq_count,
+            wall > 0 ? sim_irq_count / wall / 1e6 : 0.0);
+    fprintf(stderr, "powered down %.3f s (%.1f%%)\n",
+            (double)sim_power_down_time / F_CPU,
+            sim_time ? 100.0 * sim_power_down_time / sim_time : 0.0);
+    if (sim_ltc_writes)
+      fprintf(stderr, "LTC6903 written %lu times, last word 0x%04x\n",
+              (unsigned long)sim_ltc_writes, sim_ltc_word);
+    if (sim_adc_conversions)
+      fprintf(stderr, "ADC converted %lu times, last result %u\n",
+              (unsigned long)sim_adc_conversions, sim_io.adcw);
+    if (sim_uart_bytes)
+      fprintf(stderr, "UART sent %lu bytes\n", (unsigned long)sim_uart_bytes);
+    if (sim_syncs)
+      fprintf(stderr, "synchronized, ticks %+.3f us from the edge\n",
+              sim_sync_error * 1e6 / F_CPU);
+  }
+
+  if (eeprom)
+  {
+    if (sim_eeprom_save(eeprom))
+    {
+      perror(eeprom);
+      return 1;
+    }
+#ifdef USE_TRACE
+    fprintf(stderr, "trace log of %d blocks at 0x%02x of the EEPROM\n", TRACE_BLOCKS,
+            sim_eeprom_address(trace_log));
+#endif
+  }
+
+  if (res != SIM_DONE)
+  {
+    fprintf(stderr, "%s: firmware %s\n", argv[0],
+            res == SIM_HALTED ? "halted" : "returned from main()");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,1668 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: sim.c                                                           */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - source file of the simulated microcontroller core                     */
+/*     models the port pins with the DIP switches, Timer0 in CTC mode with   */
+/*     compare match A and B, Timer1 in normal mode with compare match A,    */
+/*     and in PWM mode with the overflow and the OC1B output, the watchdog   */
+/*     interrupt, the idle and power-down sleep and the                      */
+/*     interrupt dispatch, enough to run the unmodified firmware main loop   */
+/*     and interrupt handlers on the host                                    */
+/*     a power-down with the interrupts disabled turns the MCU off until the */
+/*     end of the simulation                                                 */
+/*     the USI is modelled in three wire mode with the software clock        */
+/*     strobe, the words shifted into the LTC6903 are recorded, with no      */
+/*     clock the DO pin is decoded as a UART line, a bit at every access     */
+/*     the DIP switches can be changed at a given time of the simulation     */
+/*     a reference pulse train can be driven on PA4, with its pin change     */
+/*     interrupt                                                             */
+/*     a sync pulse can be driven on the sync input, the offset of the       */
+/*     Timer0 ticks from its falling edge is measured after the handler      */
+/*     a brown-out reset restarts the firmware, the RAM of .noinit and the   */
+/*     EEPROM are kept, the other firmware variables are cleared             */
+/*     the EEPROM can be saved as the programmer reads it                    */
+/*     the ADC converts the bandgap against the supply, which can drop       */
+/*     linearly, the conversions are started by the ADC noise reduction      */
+/*     sleep, which stops the timers                                         */
+/*     the time of the closed DIP switches with their pull-up on is summed,  */
+/*     for the current drawn                                                 */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - first implementation                                      */
+/*                                                                           */
+/*****************************************************************************/
+
+/**** include files **********************************************************/
+
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/sleep.h>
+
+#include "config.h"
+#include "dip.h"
+#include "sim.h"
+
+/**** local function prototypes **********************************************/
+static int sim_dip_pin(SIM_PORT port, uint8_t pin, uint8_t level);
+static int sim_dip_field(uint8_t first, uint8_t bits, uint8_t value);
+static uint8_t sim_pin_level(uint8_t mask);
+static void sim_pullup_count(uint64_t time);
+static void sim_trace_outputs(void);
+static uint32_t sim_clock_div(void);
+static uint32_t sim_timer0_unit(void);
+static uint32_t sim_timer0_top(void);
+static uint32_t sim_timer0_count(void);
+static void sim_timer0_sync(void);
+static uint32_t sim_timer1_unit(void);
+static void sim_timer1_sync(void);
+static uint64_t sim_wdt_period(void);
+static void sim_wdt_sync(void);
+static void sim_irq(void (*vector)(void));
+static void sim_usi_sync(void);
+static void sim_uart_sync(void);
+static void sim_core_reset(void);
+static uint64_t sim_ref_next(void);
+static uint64_t sim_sync_next(void);
+static void sim_sync_measure(uint64_t edge);
+static uint64_t sim_timer0_match_b(void);
+static void sim_adc_sync(void);
+static uint16_t sim_adc_result(void);
+
+/**** interrupt vectors ******************************************************/
+
+// vectors are weak, a missing handler is reported as a bad interrupt
+extern void TIMER0_COMPA_vect(void) __attribute__((weak));
+extern void TIMER0_COMPB_vect(void) __attribute__((weak));
+extern void TIMER1_COMPA_vect(void) __attribute__((weak));
+extern void TIMER1_OVF_vect(void) __attribute__((weak));
+extern void WDT_vect(void) __attribute__((weak));
+extern void PCINT_vect(void) __attribute__((weak));
+extern void ADC_vect(void) __attribute__((weak));
+
+// variables of the firmware, the .bss of its objects is renamed to fw_bss,
+// so a reset clears only these
+extern uint8_t __start_fw_bss[] __attribute__((weak));
+extern uint8_t __stop_fw_bss[] __attribute__((weak));
+
+// EEPROM variables of the firmware, in a section of their own, from the
+// address 0 of the EEPROM
+extern uint8_t __start_fw_eeprom[] __attribute__((weak));
+extern uint8_t __stop_fw_eeprom[] __attribute__((weak));
+
+/**** constants **************************************************************/
+
+// no event is pending
+#define SIM_NEVER UINT64_MAX
+
+// switch pins of the DIP settings, the same table as in the firmware
+static const uint8_t dip_pins[DIP_PIN_COUNT] = DIP_PINS;
+
+static const uint16_t timer0_prescaler[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+
+// oscillator start-up time after power-down, as selected by the fuses
+// (LFUSE 0xFE: CKSEL0 = 0, SUT1:0 = 11)
+#define SIM_STARTUP_CK 1024
+
+// Timer1 PWM output B pin, PB3
+#define SIM_OC1B (1 << 3)
+
+// USI clock and data output pins, PB2, PB1
+#define SIM_USCK (1 << 2)
+#define SIM_DO (1 << 1)
+
+// start-up time from reset, as selected by the fuses
+// (LFUSE 0xFE: CKSEL0 = 0, SUT1:0 = 11: 1K CK + 14 CK + 4.1ms)
+#define SIM_RESET_CK (SIM_STARTUP_CK + 14 + F_CPU / 10000 * 41)
+
+// reference input, PA4, the pulses are high for a tenth of the period
+#define SIM_REF_PIN (1 << 4)
+#define SIM_REF_HIGH(period) ((period) / 10)
+
+// sync pulse, low for 10 ms
+#define SIM_SYNC_WIDTH (F_CPU / 100)
+
+// sim_run() restarts the firmware
+#define SIM_RESTART 0x80
+
+// bandgap reference, ADC input with MUX5:0 = 100001
+#define SIM_VBG_MV 1100
+#define SIM_ADC_VBG 0x21
+
+/**** global variables *******************************************************/
+
+SIM_IO sim_io;
+uint8_t sim_sreg_i;
+uint64_t sim_time;
+uint32_t sim_irq_count;
+uint64_t sim_power_down_time;
+uint64_t sim_pullup_time;
+double sim_wdt_freq = SIM_WDT_FREQ;
+uint16_t sim_ltc_word;
+uint32_t sim_ltc_writes;
+uint32_t sim_adc_conversions;
+uint32_t sim_uart_bytes;
+uint32_t sim_syncs;
+int64_t sim_sync_error;
+
+/**** local variables ********************************************************/
+
+// closed DIP switches and the pins already assigned by sim_set_dip()
+static uint8_t switch_closed[SIM_PORT_COUNT];
+static uint8_t switch_defined[SIM_PORT_COUNT];
+
+// DIP switch settings to be set at a time of the simulation
+static SIM_DIP dip_next;
+static uint64_t dip_time;
+
+// time of a brown-out reset
+static uint64_t reset_time;
+
+// reference pulse train: time of the first rising edge, period, and the
+// time it is disconnected
+static uint64_t ref_start;
+static uint64_t ref_period;
+static uint64_t ref_end;
+
+// sync pulse: time of its falling and rising edge
+static uint64_t sync_start;
+static uint64_t sync_end;
+
+static jmp_buf sim_end;
+static uint64_t sim_end_time;
+static SIM_OUTPUT_HOOK sim_hook;
+static SIM_OUTPUT sim_output;
+
+// Timer0 state: count length and counts in a period the next match was
+// computed for, time of the next match
+static uint32_t t0_unit;
+static uint32_t t0_top;
+static uint8_t t0_running;
+static uint64_t t0_next;
+// value of TCNT0L last read by the firmware, a change is a write
+static uint8_t t0_tcnt;
+
+// Timer1 state: count length and TOP the count base was set for, the
+// time of count 0, the time of the next compare match A and overflow
+static uint32_t t1_unit;
+static uint16_t t1_top;
+static uint8_t t1_running;
+static uint64_t t1_base;
+static uint64_t t1_next;
+static uint64_t t1_ovf;
+
+// watchdog state: control register the period was computed for, time of
+// the next time-out
+static uint8_t wdt_wdtcr;
+static uint8_t wdt_running;
+static uint64_t wdt_next;
+
+// LTC6903 state: bits shifted in since the chip was selected
+static uint16_t ltc_shift;
+static uint8_t ltc_bits;
+
+// UART state: bits of the frame received, data bits, receiver of the bytes
+static uint8_t uart_bits;
+static uint8_t uart_data;
+static SIM_UART_HOOK uart_hook;
+
+// ADC state: enabled, the next conversion is the first one after enabling,
+// end of the running conversion
+static uint8_t adc_enabled;
+static uint8_t adc_first;
+static uint64_t adc_next;
+
+// supply voltage at the start and its drop in millivolts per hour
+static double batt_mv;
+static double batt_drop;
+
+/**** local functions ********************************************************/
+
+/*===========================================================================*/
+/*  Function: sim_dip_pin                                                    */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - port: port index                                                 */
+/*        - pin: pin number                                                  */
+/*        - level: level read on the pin                                     */
+/*  Return value:                                                            */
+/*        - 0 on success, 1 if the pin was already set to another level      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    assigns a single DIP switch, switches on shared pins must agree        */
+/*===========================================================================*/
+static int sim_dip_pin(SIM_PORT port, uint8_t pin, uint8_t level)
+{
+  uint8_t mask = 1 << pin;
+  uint8_t closed = level ? 0 : mask;
+
+  if ((switch_defined[port] & mask) && (switch_closed[port] & mask) != closed)
+    return 1;
+
+  switch_defined[port] |= mask;
+  switch_closed[port] = (switch_closed[port] & ~mask) | closed;
+
+  return 0;
+}
+
+
+
+/*===========================================================================*/
+/*  Function: sim_dip_field                                                  */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - first: first entry of the setting in the pin table               */
+/*        - bits: number of bits of the setting                              */
+/*        - value: value of the setting                                      */
+/*  Return value:                                                            */
+/*        - 0 on success, nonzero if a pin was already set to another level  */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    assigns the switches of a setting, from the pin table the firmware     */
+/*    reads (dip.h), from the most significant bit                           */
+/*===========================================================================*/
+static int sim_dip_field(uint8_t first, uint8_t bits, uint8_t value)
+{
+  int err = 0;
+  uint8_t pin;
+
+  while (bits--)
+  {
+    pin = dip_pins[first++];
+    err |= sim_dip_pin((pin & DIP_PORT_B) ? SIM_PORT_B : SIM_PORT_A, pin & 7,
+                       (value >> bits) & 1);
+  }
+
+  return err;
+}
+
+#define SIM_DIP(name, value) sim_dip_field(DIP_##name##_FIRST, DIP_##name##_BITS, value)
+
+
+/*===========================================================================*/
+/*  Function: sim_pin_level                                                  */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - mask: output bit on the output port                              */
+/*  Return value:                                                            */
+/*        - SIM_PIN_* level of the pin                                       */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    current level of an output pin of the OUTPUT_PORT (PORTB), the OC1B    */
+/*    pin driven by the Timer1 PWM as the level of its filtered duty         */
+/*===========================================================================*/
+static uint8_t sim_pin_level(uint8_t mask)
+{
+  uint16_t top = ((uint16_t)(sim_io.ocr1c_hi & 0x03) << 8) | sim_io.ocr1c;
+  uint16_t ocr = ((uint16_t)(sim_io.ocr1b_hi & 0x03) << 8) | sim_io.ocr1b;
+
+  if (!mask)
+    return SIM_PIN_NC;
+  if (!(sim_io.ddrb & mask))
+    return SIM_PIN_Z;
+
+  // the Timer1 PWM drives OC1B, the level of the filtered output is high
+  // from half of the duty
+  if (mask == SIM_OC1B && (sim_io.tccr1a & (1 << PWM1B)) && (sim_io.tccr1a & (1 << COM1B1)))
+    return ((2 * (uint32_t)ocr >= top) ^ !!(sim_io.tccr1a & (1 << COM1B0))) ?
+           SIM_PIN_HIGH : SIM_PIN_LOW;
+
+  return (sim_io.portb & mask) ? SIM_PIN_HIGH : SIM_PIN_LOW;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_pullup_count                                               */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - time: end of the interval, the simulated time is its start       */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    adds the time of every closed DIP switch with its pull-up on to        */
+/*    sim_pullup_time, the pins do not change while the time is advanced     */
+/*===========================================================================*/
+static void sim_pullup_count(uint64_t time)
+{
+  uint8_t closed;
+  SIM_PORT port;
+
+  if (sim_io.mcucr & (1 << PUD))
+    return;
+
+  for (port = SIM_PORT_A; port < SIM_PORT_COUNT; port++)
+  {
+    closed = port == SIM_PORT_A ? sim_io.porta & ~sim_io.ddra
+                                : sim_io.portb & ~sim_io.ddrb;
+    closed &= switch_closed[port];
+    sim_pullup_time += (uint64_t)__builtin_popcount(closed) * (time - sim_time);
+  }
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_trace_outputs                                              */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    samples the KEY, ENABLE and LED pins and reports them to the output    */
+/*    hook if any of them changed since the last call                        */
+/*===========================================================================*/
+static void sim_trace_outputs(void)
+{
+  SIM_OUTPUT out;
+
+  out.time = sim_time;
+  out.key = sim_pin_level(OUTPUT_KEY);
+  out.enable = sim_pin_level(OUTPUT_ENABLE);
+#ifdef USE_LED
+  out.led = sim_pin_level(OUTPUT_LED);
+#else
+  out.led = SIM_PIN_NC;
+#endif
+
+  if (out.key == sim_output.key && out.enable == sim_output.enable &&
+      out.led == sim_output.led)
+    return;
+
+  sim_output = out;
+  if (sim_hook)
+    sim_hook(&out);
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_clock_div                                                  */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - system clock division factor set in CLKPR                        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the clock of the CPU and the timers is the clock source divided by     */
+/*    the CLKPR prescaler, the simulated time counts clock source cycles     */
+/*===========================================================================*/
+static uint32_t sim_clock_div(void)
+{
+  uint8_t clkps = sim_io.clkpr & 0x0F;
+
+  return (uint32_t)1 << (clkps < 8 ? clkps : 8);
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_timer0_unit                                                */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - length of one Timer0 count in clock source cycles, 0 if stopped  */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*===========================================================================*/
+static uint32_t sim_timer0_unit(void)
+{
+  uint32_t prescaler = timer0_prescaler[sim_io.tccr0b & 0x07];
+
+  if (!prescaler || (sim_io.prr & (1 << PRTIM0)))
+    return 0;
+
+  return prescaler * sim_clock_div();
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_timer0_top                                                 */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - counts in a compare match period                                 */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    Timer0 is used in 8 bit mode, in CTC mode the counter is cleared on    */
+/*    compare match A, otherwise it matches once every 256 counts            */
+/*===========================================================================*/
+static uint32_t sim_timer0_top(void)
+{
+  if (sim_io.tccr0a & (1 << CTC0))
+    return (uint32_t)sim_io.ocr0a + 1;
+
+  return 256;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_timer0_match_b                                             */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - time of the next compare match B, SIM_NEVER if none              */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the match comes OCR0B + 1 counts after the start of the period, as the */
+/*    match A, none if the counter is cleared before it, a match at the      */
+/*    current time is already passed                                         */
+/*===========================================================================*/
+static uint64_t sim_timer0_match_b(void)
+{
+  uint64_t match;
+
+  if ((uint32_t)sim_io.ocr0b + 1 >= t0_top)
+    return SIM_NEVER;
+
+  match = t0_next - (uint64_t)(t0_top - sim_io.ocr0b - 1) * t0_unit;
+  if (match <= sim_time)
+    match += (uint64_t)t0_top * t0_unit;
+
+  return match;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_timer0_count                                               */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - current value of the running counter                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the counter is cleared at the match, so it is computed back from the   */
+/*    time left until the next match                                         */
+/*===========================================================================*/
+static uint32_t sim_timer0_count(void)
+{
+  return (t0_top * t0_unit - (uint32_t)(t0_next - sim_time)) / t0_unit;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_timer0_sync                                                */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    follows the changes of the Timer0 configuration and counter made by the*/
+/*    firmware: the counter keeps its value when the clock or the period is  */
+/*    changed, or starts from the value written, the counter runs on while   */
+/*    its interrupt is off, a new period does not move its count edges, a    */
+/*    prescaler reset starts the next count a whole count later              */
+/*===========================================================================*/
+static void sim_timer0_sync(void)
+{
+  uint32_t unit = sim_timer0_unit();
+  uint32_t top = sim_timer0_top();
+  uint32_t count = sim_io.tcnt0l;
+  int restart = !t0_running || unit != t0_unit || top != t0_top;
+  uint64_t edge = sim_time;
+
+  if (t0_running)
+  {
+    // matches passed while the interrupt was disabled, a match at this time
+    // is left pending for its handler, the counter is cleared already
+    if (t0_next < sim_time || (t0_next == sim_time && !(sim_io.timsk & (1 << OCIE0A))))
+      t0_next += ((sim_time - t0_next) / (t0_top * t0_unit) + 1) * (t0_top * t0_unit);
+    count = sim_timer0_count();
+    // a new period keeps the phase of the prescaler
+    if (unit == t0_unit)
+      edge = t0_next - (uint64_t)(t0_top - count) * t0_unit;
+    count %= t0_top;
+  }
+
+  // the counter was written
+  if (sim_io.tcnt0l != t0_tcnt)
+  {
+    count = sim_io.tcnt0l;
+    edge = sim_time;
+    restart = 1;
+  }
+  // the prescaler was reset, the bit is cleared by the hardware
+  if (sim_io.gtccr & (1 << PSR0))
+  {
+    sim_io.gtccr &= ~(1 << PSR0);
+    edge = sim_time;
+    restart = 1;
+  }
+  t0_tcnt = sim_io.tcnt0l = (uint8_t)count;
+
+  if (!restart)
+    return;
+
+  t0_unit = unit;
+  t0_top = top;
+  t0_running = unit != 0;
+  if (t0_running)
+    t0_next = edge + (uint64_t)((top - count - 1 + 256) % 256 + 1) * unit;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_timer1_unit                                                */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - length of one Timer1 count in clock source cycles, 0 if stopped  */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    Timer1 is clocked synchronously from the system clock, prescaled by    */
+/*    a power of two selected by CS13:CS10                                   */
+/*===========================================================================*/
+static uint32_t sim_timer1_unit(void)
+{
+  uint8_t cs = sim_io.tccr1b & 0x0F;
+
+  if (!cs || (sim_io.prr & (1 << PRTIM1)))
+    return 0;
+
+  return ((uint32_t)1 << (cs - 1)) * sim_clock_div();
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_timer1_sync                                                */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    Timer1 counts from 0 to TOP (OCR1C with its TC1H bits) and restarts,   */
+/*    the counter is restarted when the firmware changes the clock or TOP    */
+/*    the next compare match A is computed from the current count, so the    */
+/*    firmware can move OCR1A freely, as it does in its handler              */
+/*    in the phase and frequency correct PWM mode it counts up to TOP and    */
+/*    down again, the overflow comes at BOTTOM, only the overflow is         */
+/*    modelled                                                               */
+/*===========================================================================*/
+static void sim_timer1_sync(void)
+{
+  uint16_t top = ((uint16_t)(sim_io.ocr1c_hi & 0x03) << 8) | sim_io.ocr1c;
+  uint16_t ocr = ((uint16_t)(sim_io.ocr1a_hi & 0x03) << 8) | sim_io.ocr1a;
+  uint32_t unit = sim_timer1_unit();
+  uint32_t period = (sim_io.tccr1d & (1 << WGM10)) ? 2 * (uint32_t)top : (uint32_t)top + 1;
+  uint64_t count;
+  uint32_t delta;
+
+  if (!t1_running || t1_unit != unit || t1_top != top)
+  {
+    t1_unit = unit;
+    t1_top = top;
+    t1_base = sim_time;
+    t1_running = unit != 0;
+  }
+  if (!t1_running)
+    return;
+
+  // counts elapsed since the base, the next overflow at the end of the
+  // period
+  count = (sim_time - t1_base) / unit;
+  t1_ovf = t1_base + (count / period + 1) * period * unit;
+
+  // a compare value above TOP is never reached
+  if (ocr > top)
+  {
+    t1_next = SIM_NEVER;
+    return;
+  }
+
+  // the next match is within one cycle
+  delta = (ocr + (uint32_t)top + 1 - (uint32_t)(count % (top + 1))) % (top + 1);
+  if (!delta)
+    delta = top + 1;
+
+  t1_next = t1_base + (count + delta) * unit;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_wdt_period                                                 */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - watchdog time-out period in clock source cycles                  */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the watchdog counts the cycles of its own oscillator, its frequency    */
+/*    is set by sim_wdt_freq, so the firmware calibration can be tested      */
+/*===========================================================================*/
+static uint64_t sim_wdt_period(void)
+{
+  uint8_t wdp = (sim_io.wdtcr & 0x07) | ((sim_io.wdtcr >> WDP3) & 1) << 3;
+  double cycles = (double)(2048UL << (wdp < 9 ? wdp : 9));
+
+  return (uint64_t)(cycles * F_CPU / sim_wdt_freq + 0.5);
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_wdt_sync                                                   */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    restarts the watchdog period when the firmware changed its             */
+/*    configuration, only the interrupt mode is modelled, a time-out in      */
+/*    system reset mode is not                                               */
+/*===========================================================================*/
+static void sim_wdt_sync(void)
+{
+  uint8_t wdtcr = sim_io.wdtcr & ~((1 << WDIF) | (1 << WDCE));
+
+  if (wdt_wdtcr != wdtcr)
+  {
+    wdt_wdtcr = wdtcr;
+    wdt_next = sim_time + sim_wdt_period();
+  }
+
+  wdt_running = (wdtcr & (1 << WDIE)) != 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_irq                                                        */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - vector: interrupt handler, NULL if not defined                   */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    executes an interrupt handler with the global interrupt flag cleared,  */
+/*    as the hardware does, then traces the outputs it may have changed      */
+/*===========================================================================*/
+static void sim_irq(void (*vector)(void))
+{
+  if (!vector)
+  {
+    // the real device jumps to __bad_interrupt and resets
+    longjmp(sim_end, SIM_HALTED);
+  }
+
+  sim_sreg_i = 0;
+  sim_irq_count++;
+  vector();
+  sim_sreg_i = 1;
+
+  sim_trace_outputs();
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_usi_sync                                                   */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    executes the clock strobe of the last USICR write: the USCK pin is     */
+/*    toggled, and at its rising edge the data register is shifted, the      */
+/*    LTC6903 samples the bit shifted out while it is selected, and takes    */
+/*    the word after 16 bits                                                 */
+/*    the strobe is executed at the next access of a USI register, the       */
+/*    firmware disables the USI before deselecting the chip                  */
+/*===========================================================================*/
+static void sim_usi_sync(void)
+{
+  uint8_t mode = (1 << USIWM0) | (1 << USICS1) | (1 << USICLK) | (1 << USITC);
+
+  if ((sim_io.usicr & mode) != mode || (sim_io.prr & (1 << PRUSI)))
+    return;
+  sim_io.usicr &= ~(1 << USITC);
+
+  sim_io.portb ^= SIM_USCK;
+  if (!(sim_io.portb & SIM_USCK))
+    return;
+
+#ifdef USE_LTC6903
+  if (sim_io.portb & OSC_SEN)
+    ltc_bits = 0;
+  else
+  {
+    ltc_shift = (ltc_shift << 1) | (sim_io.usidr >> 7);
+    if (++ltc_bits == 16)
+    {
+      sim_ltc_word = ltc_shift;
+      sim_ltc_writes++;
+      ltc_bits = 0;
+    }
+  }
+#endif
+  sim_io.usidr <<= 1;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_uart_sync                                                  */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    with the USI in three wire mode with no clock source, and the DO pin   */
+/*    an output, the pin follows the MSB of USIDR: the firmware writes a     */
+/*    UART bit and waits for its time, and the busy loop takes no simulated  */
+/*    time, so the level before every access of a USI register is taken as   */
+/*    a bit, 8N1 frames are decoded, a frame with no stop bit is dropped     */
+/*===========================================================================*/
+static void sim_uart_sync(void)
+{
+  uint8_t bit = sim_io.usidr >> 7;
+
+  if (sim_io.usicr != (1 << USIWM0) || !(sim_io.ddrb & SIM_DO) ||
+      (sim_io.prr & (1 << PRUSI)))
+  {
+    uart_bits = 0;
+    return;
+  }
+
+  // idle until the start bit, then the data bits from the LSB
+  if (!uart_bits)
+  {
+    if (!bit)
+      uart_bits = 1;
+    return;
+  }
+  if (uart_bits <= 8)
+  {
+    uart_data = (uart_data >> 1) | (bit << 7);
+    uart_bits++;
+    return;
+  }
+
+  uart_bits = 0;
+  if (bit)
+  {
+    sim_uart_bytes++;
+    if (uart_hook)
+      uart_hook(uart_data);
+  }
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_core_reset                                                 */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    brings the registers and the peripherals to their reset state, the     */
+/*    simulated time goes on                                                 */
+/*===========================================================================*/
+static void sim_core_reset(void)
+{
+  memset(&sim_io, 0, sizeof(sim_io));
+  sim_sreg_i = 0;
+  t0_running = 0;
+  t0_tcnt = 0;
+  t1_running = 0;
+  wdt_wdtcr = 0;
+  wdt_running = 0;
+  ltc_shift = 0;
+  ltc_bits = 0;
+  uart_bits = 0;
+  adc_enabled = 0;
+  adc_next = SIM_NEVER;
+
+  // TOP of Timer1 is 0xFF after reset
+  sim_io.ocr1c = 0xFF;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_ref_next                                                   */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - time of the next edge of the reference, SIM_NEVER if none        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    an edge at the current time is already passed                          */
+/*===========================================================================*/
+static uint64_t sim_ref_next(void)
+{
+  uint64_t phase;
+  uint64_t next;
+
+  if (!ref_period)
+    return SIM_NEVER;
+  if (sim_time < ref_start)
+    return ref_start;
+
+  phase = (sim_time - ref_start) % ref_period;
+  if (phase < SIM_REF_HIGH(ref_period))
+    next = sim_time - phase + SIM_REF_HIGH(ref_period);
+  else
+    next = sim_time - phase + ref_period;
+
+  return next < ref_end ? next : SIM_NEVER;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_sync_next                                                  */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - time of the next edge of the sync pulse, SIM_NEVER if none       */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    an edge at the current time is already passed                          */
+/*===========================================================================*/
+static uint64_t sim_sync_next(void)
+{
+  if (sim_time < sync_start)
+    return sync_start;
+  if (sim_time < sync_end)
+    return sync_end;
+
+  return SIM_NEVER;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_sync_measure                                               */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - edge: time of the falling edge of the sync pulse                 */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    called after the handler of the edge: the offset of the Timer0 ticks   */
+/*    from the edge, modulo a tick, is 0 if the timer was restarted at the   */
+/*    edge, positive if the ticks come later                                 */
+/*===========================================================================*/
+static void sim_sync_measure(uint64_t edge)
+{
+  uint64_t tick;
+  uint64_t phase;
+
+  sim_timer0_sync();
+  if (!t0_running)
+    return;
+
+  tick = (uint64_t)t0_top * t0_unit;
+  phase = (t0_next - edge) % tick;
+  sim_sync_error = phase <= tick / 2 ? (int64_t)phase : (int64_t)phase - (int64_t)tick;
+  sim_syncs++;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_adc_result                                                 */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - result of a conversion at the current time                       */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    only the bandgap input against the supply is modelled, the other       */
+/*    inputs and references read 0                                           */
+/*===========================================================================*/
+static uint16_t sim_adc_result(void)
+{
+  uint8_t mux = (sim_io.admux & 0x1F) | ((sim_io.adcsrb >> MUX5) & 1) << 5;
+  uint8_t refs = (sim_io.admux >> REFS0) | ((sim_io.adcsrb >> REFS2) & 1) << 2;
+  double mv = batt_mv - batt_drop * sim_time / F_CPU / 3600;
+  double result;
+
+  if (mux != SIM_ADC_VBG || refs || mv <= 0)
+    return 0;
+
+  result = SIM_VBG_MV * 1024 / mv + 0.5;
+  return result < 1023 ? (uint16_t)result : 1023;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_adc_sync                                                   */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    follows the ADC enable bit and its power reduction bit, a disabled ADC */
+/*    aborts its conversion, the first conversion after enabling is the long */
+/*    one, the result of a conversion ended is written here                  */
+/*===========================================================================*/
+static void sim_adc_sync(void)
+{
+  if (!(sim_io.adcsra & (1 << ADEN)) || (sim_io.prr & (1 << PRADC)))
+  {
+    adc_enabled = 0;
+    adc_next = SIM_NEVER;
+    sim_io.adcsra &= ~(1 << ADSC);
+    return;
+  }
+
+  if (!adc_enabled)
+  {
+    adc_enabled = 1;
+    adc_first = 1;
+  }
+
+  if (adc_next <= sim_time)
+  {
+    sim_io.adcw = sim_adc_result();
+    sim_io.adcsra &= ~(1 << ADSC);
+    adc_next = SIM_NEVER;
+    sim_adc_conversions++;
+  }
+}
+
+
+/**** global functions *******************************************************/
+
+/*===========================================================================*/
+/*  Function: sim_reset                                                      */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    brings the simulated core to its power-on reset state, the DIP         */
+/*    switches are left unchanged                                            */
+/*===========================================================================*/
+void sim_reset(void)
+{
+  sim_core_reset();
+  sim_io.mcusr = 1 << PORF;
+  sim_time = 0;
+  sim_irq_count = 0;
+  sim_power_down_time = 0;
+  sim_pullup_time = 0;
+  dip_time = SIM_NEVER;
+  reset_time = SIM_NEVER;
+  ref_period = 0;
+  sync_start = SIM_NEVER;
+  sync_end = SIM_NEVER;
+  sim_syncs = 0;
+  sim_ltc_word = 0;
+  sim_ltc_writes = 0;
+  sim_adc_conversions = 0;
+  batt_mv = SIM_BATTERY_MV;
+  batt_drop = 0;
+
+  sim_output.time = 0;
+  sim_output.key = sim_pin_level(OUTPUT_KEY);
+  sim_output.enable = sim_pin_level(OUTPUT_ENABLE);
+  sim_output.led = SIM_PIN_NC;
+#ifdef USE_LED
+  sim_output.led = sim_pin_level(OUTPUT_LED);
+#endif
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_set_dip                                                    */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - dip: DIP switch settings                                         */
+/*  Return value:                                                            */
+/*        - 0 on success, nonzero if two settings conflict on a shared pin   */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    translates the DIP field values to closed switches, using the same pin */
+/*    map from config.h that the firmware reads                              */
+/*===========================================================================*/
+int sim_set_dip(const SIM_DIP *dip)
+{
+  int err = 0;
+
+  memset(switch_closed, 0, sizeof(switch_closed));
+  memset(switch_defined, 0, sizeof(switch_defined));
+
+  err |= SIM_DIP(CODE, dip->code);
+  err |= SIM_DIP(SPEED, dip->speed);
+  err |= SIM_DIP(INTERVAL_LENGTH, dip->interval_length);
+  err |= SIM_DIP(INTERVAL, dip->interval);
+#ifdef USE_LEVEL_SETTING
+  err |= SIM_DIP(KEY_LEVEL, dip->key_level);
+  err |= SIM_DIP(ENABLE_LEVEL, dip->enable_level);
+#endif
+#ifdef USE_PROG_FREQ
+  err |= SIM_DIP(FREQ, dip->freq);
+#endif
+
+  return err;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_change_dip                                                 */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - time: clock source cycles since reset                            */
+/*        - dip: DIP switch values                                           */
+/*  Return value:                                                            */
+/*        - 0 on success, non zero if two settings conflict on a shared pin  */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the switches are set at the first wake-up after the given time, as     */
+/*    an operator changing them on a running controller                      */
+/*===========================================================================*/
+int sim_change_dip(uint64_t time, const SIM_DIP *dip)
+{
+  uint8_t closed[SIM_PORT_COUNT];
+  uint8_t defined[SIM_PORT_COUNT];
+  int err;
+
+  // the settings are checked now, and set later
+  memcpy(closed, switch_closed, sizeof(closed));
+  memcpy(defined, switch_defined, sizeof(defined));
+  err = sim_set_dip(dip);
+  memcpy(switch_closed, closed, sizeof(closed));
+  memcpy(switch_defined, defined, sizeof(defined));
+
+  if (!err)
+  {
+    dip_next = *dip;
+    dip_time = time;
+  }
+
+  return err;
+}
+
+/*===========================================================================*/
+/*  Function: sim_brown_out                                                  */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - time: clock source cycles since reset                            */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    a brown-out reset at the first sleep after the given time, the supply  */
+/*    drops below the BOD level but the RAM is kept                          */
+/*===========================================================================*/
+void sim_brown_out(uint64_t time)
+{
+  reset_time = time;
+}
+
+/*===========================================================================*/
+/*  Function: sim_reference                                                  */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - start: time of the first rising edge                             */
+/*        - period: period of the pulses                                     */
+/*        - end: time the reference is disconnected                          */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    drives a pulse train on the reference input, all times in clock source */
+/*    cycles, the DIP switch of the pin shall be open                        */
+/*===========================================================================*/
+void sim_reference(uint64_t start, uint64_t period, uint64_t end)
+{
+  ref_start = start;
+  ref_period = period;
+  ref_end = end;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_sync                                                       */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - time: time of the falling edge, in clock source cycles           */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    pulls the sync input low for SIM_SYNC_WIDTH, as a starter does         */
+/*===========================================================================*/
+void sim_sync(uint64_t time)
+{
+  sync_start = time;
+  sync_end = time + SIM_SYNC_WIDTH;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_uart                                                       */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - hook: called with every byte sent on the UART line, or NULL      */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*===========================================================================*/
+void sim_uart(SIM_UART_HOOK hook)
+{
+  uart_hook = hook;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_battery                                                    */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - mv: supply voltage at the start, in millivolts                   */
+/*        - drop: drop of the supply in millivolts per hour                  */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    sets the supply measured by the ADC, it drops linearly with the time   */
+/*===========================================================================*/
+void sim_battery(double mv, double drop)
+{
+  batt_mv = mv;
+  batt_drop = drop;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_eeprom_address                                             */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - var: EEPROM variable of the firmware                             */
+/*  Return value:                                                            */
+/*        - its address in the EEPROM                                        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*===========================================================================*/
+unsigned sim_eeprom_address(const void *var)
+{
+  return (unsigned)((const uint8_t *)var - __start_fw_eeprom);
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_eeprom_save                                                */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - path: output file                                                */
+/*  Return value:                                                            */
+/*        - 0 on success, -1 if the file can not be written                  */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    writes the EEPROM in Intel HEX records of 16 bytes, as the programmer  */
+/*    reads it from the device                                               */
+/*===========================================================================*/
+int sim_eeprom_save(const char *path)
+{
+  unsigned size = __start_fw_eeprom ? (unsigned)(__stop_fw_eeprom - __start_fw_eeprom) : 0;
+  unsigned addr;
+  unsigned count;
+  unsigned i;
+  uint8_t sum;
+  FILE *out = fopen(path, "w");
+
+  if (!out)
+    return -1;
+
+  for (addr = 0; addr < size; addr += count)
+  {
+    count = size - addr < 16 ? size - addr : 16;
+    sum = (uint8_t)(count + (addr >> 8) + addr);
+    fprintf(out, ":%02X%04X00", count, addr);
+    for (i = 0; i < count; i++)
+    {
+      fprintf(out, "%02X", __start_fw_eeprom[addr + i]);
+      sum += __start_fw_eeprom[addr + i];
+    }
+    fprintf(out, "%02X\n", (uint8_t)-sum);
+  }
+  fprintf(out, ":00000001FF\n");
+
+  return fclose(out) ? -1 : 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_pin_read                                                   */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - port: port index                                                 */
+/*  Return value:                                                            */
+/*        - pin levels as read from PINx                                     */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    computes the value of a PINx register: outputs read back their driven  */
+/*    level, inputs read high through the pull-up unless the DIP switch on   */
+/*    the pin is closed, inputs without pull-up are reported as low          */
+/*    the pins of port A with the digital input disabled in DIDR0 read low   */
+/*===========================================================================*/
+uint8_t sim_pin_read(SIM_PORT port)
+{
+  uint8_t out = port == SIM_PORT_A ? sim_io.porta : sim_io.portb;
+  uint8_t ddr = port == SIM_PORT_A ? sim_io.ddra : sim_io.ddrb;
+  uint8_t pullup = (sim_io.mcucr & (1 << PUD)) ? 0 : out & ~ddr;
+  uint8_t disabled = port == SIM_PORT_A ? sim_io.didr0 : 0;
+  uint8_t pins = (out & ddr) | (pullup & ~switch_closed[port]);
+  uint64_t phase;
+
+  // the reference drives its pin
+  if (port == SIM_PORT_A && ref_period && sim_time >= ref_start && sim_time < ref_end)
+  {
+    phase = (sim_time - ref_start) % ref_period;
+    pins &= ~SIM_REF_PIN;
+    if (phase < SIM_REF_HIGH(ref_period))
+      pins |= SIM_REF_PIN;
+  }
+
+  // the sync pulse pulls its line low
+  if (port == SIM_PORT_A && sim_time >= sync_start && sim_time < sync_end)
+    pins &= ~SYNC_PIN;
+
+  return pins & ~disabled;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_tcnt0                                                      */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - pointer to the TCNT0L register                                   */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    computes the current count of Timer0 from the simulated time, a value  */
+/*    written through the returned pointer is applied at the next sleep      */
+/*===========================================================================*/
+uint8_t *sim_tcnt0(void)
+{
+  sim_timer0_sync();
+
+  return &sim_io.tcnt0l;
+}
+
+/*===========================================================================*/
+/*  Function: sim_tcnt1                                                      */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - pointer to the TCNT1 register                                    */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    computes the current count of Timer1 from the simulated time, the high */
+/*    bits are latched in TC1H, as by the read of the low byte, the counter  */
+/*    can not be written                                                     */
+/*===========================================================================*/
+uint8_t *sim_tcnt1(void)
+{
+  uint16_t count = 0;
+
+  sim_timer1_sync();
+  if (t1_running)
+    count = (uint16_t)((sim_time - t1_base) / t1_unit % (t1_top + 1));
+  sim_io.tc1h = count >> 8;
+  sim_io.tcnt1 = count & 0xFF;
+
+  return &sim_io.tcnt1;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_tifr                                                       */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - pointer to the TIFR register                                     */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the interrupt handlers run at the exact time of their event, so the    */
+/*    firmware sees a pending flag only when an other handler is run at the  */
+/*    same time, the flags written (cleared) by the firmware are dropped     */
+/*===========================================================================*/
+uint8_t *sim_tifr(void)
+{
+  sim_timer0_sync();
+  sim_io.tifr = 0;
+  if (t0_running && t0_next <= sim_time)
+    sim_io.tifr |= 1 << OCF0A;
+
+  return &sim_io.tifr;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_usi                                                        */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - reg: USI register                                                */
+/*  Return value:                                                            */
+/*        - pointer to the register                                          */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the clock strobe of the last USICR write is executed before the next   */
+/*    access of a USI register, and the UART bit is taken                    */
+/*===========================================================================*/
+uint8_t *sim_usi(uint8_t *reg)
+{
+  sim_usi_sync();
+  sim_uart_sync();
+
+  return reg;
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_wdt_reset                                                  */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    executes the wdr instruction, the watchdog period restarts             */
+/*===========================================================================*/
+void sim_wdt_reset(void)
+{
+  sim_wdt_sync();
+  wdt_next = sim_time + sim_wdt_period();
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_sleep                                                      */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    executes the sleep instruction: the simulated time advances to the     */
+/*    next interrupt enabled in the sleep mode, which is then serviced       */
+/*    in power-down only the watchdog wakes the MCU, after the oscillator    */
+/*    start-up time, with no wake-up source the MCU is turned off            */
+/*    the ADC noise reduction sleep starts a conversion, the timers stop     */
+/*    until the wake-up, as in power-down                                    */
+/*    when the end of the simulation is reached, control returns to          */
+/*    sim_run() without returning to the firmware                            */
+/*===========================================================================*/
+void sim_sleep(void)
+{
+  uint8_t mode = sim_io.mcucr & ((1 << SM1) | (1 << SM0));
+  uint64_t t0 = SIM_NEVER;
+  uint64_t t0b = SIM_NEVER;
+  uint64_t t1 = SIM_NEVER;
+  uint64_t t1o = SIM_NEVER;
+  uint64_t wdt = SIM_NEVER;
+  uint64_t pc = SIM_NEVER;
+  uint64_t sync;
+  uint64_t adc = SIM_NEVER;
+  uint64_t next;
+  uint64_t wake;
+  void (*vector)(void);
+
+  sim_trace_outputs();
+  sim_timer0_sync();
+  sim_timer1_sync();
+  sim_wdt_sync();
+  sim_adc_sync();
+
+  // the ADC noise reduction sleep starts a conversion, the ADC clock is
+  // the system clock prescaled by ADPS2:0
+  if (mode == SLEEP_MODE_ADC && adc_enabled && adc_next == SIM_NEVER)
+  {
+    adc_next = sim_time + (uint64_t)(adc_first ? 25 : 13) *
+               ((sim_io.adcsra & 0x07) > 1 ? 1 << (sim_io.adcsra & 0x07) : 2) *
+               sim_clock_div();
+    adc_first = 0;
+    sim_io.adcsra |= 1 << ADSC;
+  }
+  if (mode != SLEEP_MODE_PWR_DOWN && (sim_io.adcsra & (1 << ADIE)))
+    adc = adc_next;
+
+  // the timers are clocked from the I/O clock, stopped in the ADC noise
+  // reduction and the power-down sleep
+  if (mode == SLEEP_MODE_IDLE)
+  {
+    if (t0_running && (sim_io.timsk & (1 << OCIE0A)))
+      t0 = t0_next;
+    if (t0_running && (sim_io.timsk & (1 << OCIE0B)))
+      t0b = sim_timer0_match_b();
+    if (t1_running && (sim_io.timsk & (1 << OCIE1A)))
+      t1 = t1_next;
+    if (t1_running && (sim_io.timsk & (1 << TOIE1)))
+      t1o = t1_ovf;
+  }
+  if (wdt_running)
+    wdt = wdt_next;
+  // the pin change is asynchronous, it wakes from power-down too
+  if ((sim_io.gimsk & (1 << PCIE1)) && (sim_io.pcmsk0 & SIM_REF_PIN))
+    pc = sim_ref_next();
+  if ((sim_io.gimsk & (1 << PCIE1)) && (sim_io.pcmsk0 & SYNC_PIN))
+  {
+    sync = sim_sync_next();
+    pc = pc < sync ? pc : sync;
+  }
+  next = t0 < t1 ? t0 : t1;
+  next = next < t1o ? next : t1o;
+  next = next < t0b ? next : t0b;
+  next = next < wdt ? next : wdt;
+  next = next < pc ? next : pc;
+  next = next < adc ? next : adc;
+  // with the interrupts disabled nothing is serviced, the MCU is off
+  if (mode == SLEEP_MODE_PWR_DOWN && !sim_sreg_i)
+    next = SIM_NEVER;
+
+  // the reset comes before any interrupt
+  if (reset_time <= next && reset_time <= sim_end_time)
+  {
+    if (mode == SLEEP_MODE_PWR_DOWN)
+      sim_power_down_time += reset_time - sim_time;
+    sim_pullup_count(reset_time);
+    sim_time = reset_time;
+    longjmp(sim_end, SIM_RESTART);
+  }
+
+  // a power-down with no wake-up source turns the MCU off, it lasts until
+  // the end of the simulation, an idle sleep hangs the firmware
+  if (mode != SLEEP_MODE_PWR_DOWN && (!sim_sreg_i || next == SIM_NEVER))
+    longjmp(sim_end, SIM_HALTED);
+
+  if (next > sim_end_time)
+  {
+    if (mode == SLEEP_MODE_PWR_DOWN)
+      sim_power_down_time += sim_end_time - sim_time;
+    sim_pullup_count(sim_end_time);
+    sim_time = sim_end_time;
+    longjmp(sim_end, SIM_DONE);
+  }
+
+  // the pin change has the highest priority of the vectors used
+  if (next == pc)
+  {
+    vector = PCINT_vect;
+  }
+  else if (next == t0)
+  {
+    t0_next += t0_top * t0_unit;
+    vector = TIMER0_COMPA_vect;
+  }
+  else if (next == t1)
+  {
+    vector = TIMER1_COMPA_vect;
+  }
+  else if (next == t1o)
+  {
+    vector = TIMER1_OVF_vect;
+  }
+  else if (next == t0b)
+  {
+    vector = TIMER0_COMPB_vect;
+  }
+  else if (next == adc)
+  {
+    vector = ADC_vect;
+  }
+  else
+  {
+    wdt_next += sim_wdt_period();
+    vector = WDT_vect;
+  }
+
+  // waking up from power-down the clock is stopped until the oscillator
+  // starts up, the timers are frozen for the whole time
+  wake = next;
+  if (mode == SLEEP_MODE_PWR_DOWN)
+  {
+    wake += SIM_STARTUP_CK;
+    sim_power_down_time += next - sim_time;
+  }
+  if (mode != SLEEP_MODE_IDLE)
+  {
+    t0_next += wake - sim_time;
+    t1_base += wake - sim_time;
+    t1_next += wake - sim_time;
+    t1_ovf += wake - sim_time;
+  }
+
+  sim_pullup_count(wake);
+  sim_time = wake;
+  sim_adc_sync();
+
+  // the switches changed while the MCU was sleeping
+  if (sim_time >= dip_time)
+  {
+    sim_set_dip(&dip_next);
+    dip_time = SIM_NEVER;
+  }
+
+  sim_irq(vector);
+
+  if (vector == PCINT_vect && next == sync_start)
+    sim_sync_measure(next);
+}
+
+
+/*===========================================================================*/
+/*  Function: sim_run                                                        */
+/*  Module:   sim                                                            */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - cycles: clock source cycles to simulate                          */
+/*        - hook: called on every output change, can be NULL                 */
+/*  Return value:                                                            */
+/*        - reason of the return                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    runs the firmware from its entry point for the given time, and again   */
+/*    after a brown-out reset                                                */
+/*    the firmware state is not reset between runs, so every simulation      */
+/*    shall be done in a fresh process                                       */
+/*===========================================================================*/
+SIM_RESULT sim_run(uint64_t cycles, SIM_OUTPUT_HOOK hook)
+{
+  int ret;
+
+  sim_end_time = sim_time + cycles;
+  sim_hook = hook;
+
+  ret = setjmp(sim_end);
+  if (ret == SIM_RESTART)
+  {
+    // the pins are inputs while the reset is held, the firmware starts
+    // again after the start-up time, with its variables cleared
+    sim_core_reset();
+    sim_io.mcusr = 1 << BORF;
+    reset_time = SIM_NEVER;
+    sim_trace_outputs();
+    sim_time += SIM_RESET_CK;
+    if (__start_fw_bss)
+      memset(__start_fw_bss, 0, __stop_fw_bss - __start_fw_bss);
+  }
+  if (!ret || ret == SIM_RESTART)
+  {
+    firmware_main();
+    ret = SIM_RETURNED;
+  }
+
+  return (SIM_RESULT)ret;
+}
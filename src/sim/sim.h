@@ -0,0 +1,165 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: sim.h                                                           */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - simulated ATtiny261/461/861 core for the host build of the firmware   */
+/*     only the peripherals used by the firmware are modelled, simulated time*/
+/*     advances when the firmware goes to sleep, the next pending interrupt  */
+/*     is then executed, and the output pins are traced after every handler  */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <stdint.h>
+
+/**** types ******************************************************************/
+
+typedef enum
+{
+    SIM_PORT_A = 0,
+    SIM_PORT_B,
+    SIM_PORT_COUNT
+} SIM_PORT;
+
+// simulated register file, only the registers used by the firmware
+typedef struct
+{
+    uint8_t porta;
+    uint8_t ddra;
+    uint8_t portb;
+    uint8_t ddrb;
+    uint8_t prr;
+    uint8_t acsra;
+    uint8_t tccr0a;
+    uint8_t tccr0b;
+    uint8_t ocr0a;
+    uint8_t ocr0b;
+    uint8_t tcnt0l;
+    uint8_t gtccr;
+    uint8_t timsk;
+    uint8_t tifr;
+    uint8_t tccr1a;
+    uint8_t tccr1b;
+    uint8_t tccr1c;
+    uint8_t tccr1d;
+    uint8_t tc1h;
+    uint8_t tcnt1;
+    uint8_t ocr1a;
+    uint8_t ocr1a_hi;
+    uint8_t ocr1b;
+    uint8_t ocr1b_hi;
+    uint8_t ocr1c;
+    uint8_t ocr1c_hi;
+    uint8_t usicr;
+    uint8_t usisr;
+    uint8_t usidr;
+    uint8_t mcucr;
+    uint8_t mcusr;
+    uint8_t clkpr;
+    uint8_t wdtcr;
+    uint8_t gpior0;
+    uint8_t didr0;
+    uint8_t gimsk;
+    uint8_t pcmsk0;
+    uint8_t pcmsk1;
+    uint8_t admux;
+    uint8_t adcsra;
+    uint8_t adcsrb;
+    uint16_t adcw;
+} SIM_IO;
+
+// DIP switch settings, every field holds the value read by DIP(name),
+// so a 0 bit is a closed switch (pin pulled to ground)
+typedef struct
+{
+    uint8_t code;
+    uint8_t speed;
+    uint8_t interval_length;
+    uint8_t interval;
+    uint8_t key_level;
+    uint8_t enable_level;
+    uint8_t freq;
+} SIM_DIP;
+
+// output pin levels
+#define SIM_PIN_LOW   0
+#define SIM_PIN_HIGH  1
+#define SIM_PIN_Z     2   // pin is an input
+#define SIM_PIN_NC    3   // pin is not used on this board variant
+
+typedef struct
+{
+    uint64_t time;    // clock source cycles since reset
+    uint8_t key;
+    uint8_t enable;
+    uint8_t led;
+} SIM_OUTPUT;
+
+typedef void (*SIM_OUTPUT_HOOK)(const SIM_OUTPUT *out);
+typedef void (*SIM_UART_HOOK)(uint8_t byte);
+
+// nominal frequency of the watchdog oscillator
+#define SIM_WDT_FREQ  128000
+
+// supply voltage in millivolts, a fresh 3 cell battery
+#define SIM_BATTERY_MV  4500
+
+// reasons for sim_run() to return
+typedef enum
+{
+    SIM_DONE = 1,     // requested time elapsed
+    SIM_HALTED,       // firmware sleeps with no wake-up source
+    SIM_RETURNED      // firmware main() returned
+} SIM_RESULT;
+
+/**** global variables *******************************************************/
+
+extern SIM_IO sim_io;
+extern uint8_t sim_sreg_i;
+extern uint64_t sim_time;
+extern uint32_t sim_irq_count;
+extern uint64_t sim_power_down_time;
+extern uint64_t sim_pullup_time;
+extern double sim_wdt_freq;
+extern uint16_t sim_ltc_word;
+extern uint32_t sim_ltc_writes;
+extern uint32_t sim_adc_conversions;
+extern uint32_t sim_uart_bytes;
+extern uint32_t sim_syncs;
+extern int64_t sim_sync_error;
+
+/**** global functions *******************************************************/
+
+void sim_reset(void);
+int sim_set_dip(const SIM_DIP *dip);
+int sim_change_dip(uint64_t time, const SIM_DIP *dip);
+void sim_brown_out(uint64_t time);
+void sim_reference(uint64_t start, uint64_t period, uint64_t end);
+void sim_sync(uint64_t time);
+void sim_battery(double mv, double drop);
+void sim_uart(SIM_UART_HOOK hook);
+unsigned sim_eeprom_address(const void *var);
+int sim_eeprom_save(const char *path);
+SIM_RESULT sim_run(uint64_t cycles, SIM_OUTPUT_HOOK hook);
+
+// firmware hooks, used by the replacement AVR headers
+uint8_t sim_pin_read(SIM_PORT port);
+uint8_t *sim_tcnt0(void);
+uint8_t *sim_tcnt1(void);
+uint8_t *sim_tifr(void);
+uint8_t *sim_usi(uint8_t *reg);
+void sim_wdt_reset(void);
+void sim_sleep(void);
+
+// firmware entry point, renamed for the host build
+int firmware_main(void);
+
+#endif /*__SIM_H__*/
@@ -0,0 +1,33 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: crc16.h                                                         */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - host replacement of <util/crc16.h> for the simulator build            */
+/*     the C equivalent of the inline assembly of avr-libc                   */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef __SIM_UTIL_CRC16_H__
+#define __SIM_UTIL_CRC16_H__
+
+#include <stdint.h>
+
+// CRC-8, polynomial x^8 + x^2 + x + 1
+static inline uint8_t _crc8_ccitt_update(uint8_t crc, uint8_t data)
+{
+  uint8_t i;
+
+  crc ^= data;
+  for (i = 0; i < 8; i++)
+    crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+
+  return crc;
+}
+
+#endif /*__SIM_UTIL_CRC16_H__*/
@@ -0,0 +1,23 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: delay_basic.h                                                   */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - host replacement of <util/delay_basic.h> for the simulator build      */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef __SIM_UTIL_DELAY_BASIC_H__
+#define __SIM_UTIL_DELAY_BASIC_H__
+
+#include <stdint.h>
+
+// the simulated pins settle at once, busy loops take no simulated time
+#define _delay_loop_1(count) ((void)(uint8_t)(count))
+
+#endif /*__SIM_UTIL_DELAY_BASIC_H__*/
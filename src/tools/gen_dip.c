@@ -0,0 +1,201 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: gen_dip.c                                                       */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - build time generator of the DIP switch decoding tables                */
+/*     converts the pin map of the board variant in config.h into a single   */
+/*     table of switch pins, read by one loop in the firmware, and the       */
+/*     interval switches and the code into lookup tables                     */
+/*   - the pin map is checked: every pin of port B shall have its pull-up    */
+/*     in PORTB_DIP_PINS, and the interval counter shall fit in 16 bits      */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - first implementation                                      */
+/*                                                                           */
+/*****************************************************************************/
+
+/**** include files **********************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "config.h"
+
+/**** local function prototypes **********************************************/
+static int add_field(const char *name, const int *pins, int bits);
+
+/**** constants **************************************************************/
+
+// a pin of the map as a table entry: the pin number, with DIP_PORT_B on
+// port B, every setting from its most significant bit
+#define PORT_CODE_A 0
+#define PORT_CODE_B DIP_PORT_B
+#define PIN_CODE(port, pin) (PORT_CODE_##port | (pin))
+#define PIN_CODE_EXP(port, pin) PIN_CODE(port, pin)
+#define FIELD_PIN(name, pos) PIN_CODE_EXP(DIP_##name##_BIT##pos##_PORT, DIP_##name##_BIT##pos##_PIN)
+#define FIELD_PINS_1(name) { FIELD_PIN(name, 0) }
+#define FIELD_PINS_2(name) { FIELD_PIN(name, 1), FIELD_PIN(name, 0) }
+#define FIELD_PINS_3(name) { FIELD_PIN(name, 2), FIELD_PIN(name, 1), FIELD_PIN(name, 0) }
+#define FIELD_PINS(count, name) FIELD_PINS_##count(name)
+#define FIELD_PINS_EXP(count, name) FIELD_PINS(count, name)
+
+#define FIELD(name) \
+  do \
+  { \
+    static const int pins[] = FIELD_PINS_EXP(DIP_##name##_BITS, name); \
+    errors += add_field(#name, pins, DIP_##name##_BITS); \
+  } while (0)
+
+#define MAX_PINS 32
+
+static const uint8_t interval_foxes[] = DIP_INTERVAL_FOXES;
+static const char * const length_names[2] = { "long", "short" };
+static const int length_seconds[2] = { INTERVAL_LONG, INTERVAL_SHORT };
+
+/**** local variables ********************************************************/
+
+// the pin table, and a comment with the port and pin of every entry
+static int table[MAX_PINS];
+static char comment[MAX_PINS][8];
+static int entries;
+
+/**** local functions ********************************************************/
+
+/*===========================================================================*/
+/*  Function: add_field                                                      */
+/*  Module:   gen_dip                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - name: name of the setting                                        */
+/*        - pins: table entries of the bits, from the most significant one   */
+/*        - bits: number of bits                                             */
+/*  Return value:                                                            */
+/*        - number of errors                                                 */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the position of the setting in the pin table, and appends its   */
+/*    pins, a pin of port B without a pull-up is an error                    */
+/*===========================================================================*/
+static int add_field(const char *name, const int *pins, int bits)
+{
+  int errors = 0;
+  int i;
+
+  printf("#define DIP_%s_FIRST %d\n", name, entries);
+  for (i = 0; i < bits; i++)
+  {
+    int pin = pins[i] & ~DIP_PORT_B;
+    int port_b = pins[i] & DIP_PORT_B;
+
+    if (pin > 7)
+    {
+      fprintf(stderr, "gen_dip: %s bit %d is on pin %d, out of the port\n",
+              name, bits - 1 - i, pin);
+      errors++;
+    }
+    if (port_b && !(PORTB_DIP_PINS & (1 << pin)))
+    {
+      fprintf(stderr, "gen_dip: %s bit %d on PB%d has no pull-up in PORTB_DIP_PINS\n",
+              name, bits - 1 - i, pin);
+      errors++;
+    }
+    snprintf(comment[entries], sizeof(comment[entries]), "P%c%d", port_b ? 'B' : 'A', pin);
+    table[entries++] = pins[i];
+  }
+
+  return errors;
+}
+
+
+/*===========================================================================*/
+/*  Function: main                                                           */
+/*  Module:   gen_dip                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - 0 on success, 1 on error                                         */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints dip.h to the standard output                                    */
+/*===========================================================================*/
+int main(void)
+{
+  int errors = 0;
+  int l, i, c;
+
+  if (sizeof(interval_foxes) != 1 << DIP_INTERVAL_BITS)
+  {
+    fprintf(stderr, "gen_dip: DIP_INTERVAL_FOXES shall have %d entries\n",
+            1 << DIP_INTERVAL_BITS);
+    return 1;
+  }
+
+  printf("// dip.h: generated by gen_dip from the pin map of config.h, do not edit\n\n");
+  printf("#ifndef __DIP_H__\n#define __DIP_H__\n\n");
+
+  printf("// first entry of every setting in DIP_PINS\n");
+  FIELD(CODE);
+  FIELD(SPEED);
+  FIELD(INTERVAL_LENGTH);
+  FIELD(INTERVAL);
+#ifdef USE_LEVEL_SETTING
+  FIELD(KEY_LEVEL);
+  FIELD(ENABLE_LEVEL);
+#endif
+#ifdef USE_PROG_FREQ
+  FIELD(FREQ);
+#endif
+
+  printf("\n// switch pins of the settings, from their most significant bit: the pin\n");
+  printf("// number, with DIP_PORT_B on port B\n//");
+  for (i = 0; i < entries; i++)
+    printf(" %s", comment[i]);
+  printf("\n#define DIP_PIN_COUNT %d\n\n", entries);
+  printf("#define DIP_PINS \\\n  { \\\n   ");
+  for (i = 0; i < entries; i++)
+    printf(" 0x%02x,", table[i]);
+  printf(" \\\n  }\n\n");
+
+  printf("// interval counter period in ticks, indexed by the interval length and\n");
+  printf("// the interval switches, 0 for continuous keying\n");
+  printf("#define DIP_INTERVALS \\\n  { \\\n");
+  for (l = 0; l < 2; l++)
+  {
+    printf("    {");
+    for (i = 0; i < 1 << DIP_INTERVAL_BITS; i++)
+    {
+      long count = (long)interval_foxes[i] * INTERVAL_COUNT(length_seconds[l]);
+
+      if (count > UINT16_MAX)
+      {
+        fprintf(stderr, "gen_dip: %s interval %d is out of the 16 bit counter\n",
+                length_names[l], i);
+        errors++;
+      }
+      printf(" %ld,", count);
+    }
+    printf(" }, /* %s */ \\\n", length_names[l]);
+  }
+  printf("  }\n\n");
+
+  printf("// enable periods before the window of the fox in the cycle of its set,\n");
+  printf("// indexed by DIP_CODE_VALUE\n");
+  printf("#define DIP_POSITIONS {");
+  for (c = 0; c <= DIP_CODE_MSG; c++)
+    printf(" %d,", c >= DIP_CODE_MOE && c <= DIP_CODE_MO5 ? c - DIP_CODE_MOE : 0);
+  printf(" }\n\n");
+
+  printf("#endif /*__DIP_H__*/\n");
+
+  return errors ? 1 : 0;
+}
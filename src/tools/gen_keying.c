@@ -0,0 +1,885 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: gen_keying.c                                                    */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - build time generator of the keying schedule tables                    */
+/*     encodes the messages of codes.h, and the optional beacon message,     */
+/*     into morse code, and converts them into run-length tables, one entry  */
+/*     for every element (key level and length in timer ticks), for every    */
+/*     code and code speed, the output is a header included by main.c        */
+/*   - computes the word space for every interval length, so that the last   */
+/*     whole word of an enable period ends a word space before the TXOFF     */
+/*     tone, and verifies the result on the tables, writing a report         */
+/*   - the sign length is a fraction of ticks for most speeds, the element   */
+/*     edges are placed on the nearest tick of their exact time, the word    */
+/*     space is given as a whole part and a remainder, which the interrupt   */
+/*     handler accumulates from word to word                                 */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - first implementation                                      */
+/*               - word space computation and verification report            */
+/*               - exact timing for any code speed                           */
+/*               - morse encoder for plain text messages                     */
+/*                                                                           */
+/*****************************************************************************/
+
+/**** include files **********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "config.h"
+#include "codes.h"
+
+/**** local function prototypes **********************************************/
+static const char *code_name(int c);
+static const char *morse_char(char ch);
+static int encode_message(int c, const char *text);
+static int read_message(const char *file, char *text, int size);
+static void add_run(int c, int s, uint8_t level, int ticks);
+static void build_keying(int c, int s);
+static void print_keying(int c, int s);
+#ifndef USE_FIXED
+static void print_spacing(const char *type, const char *name, size_t field);
+#endif
+static long gcd(long a, long b);
+static int sign_edge(int s, int pos);
+static void compute_space(int c, int s, int l);
+static void compute_continuous(int c, int s);
+static int verify_window(int c, int s, int l, FILE *report);
+static int verify_continuous(int c, int s, FILE *report);
+
+/**** constants **************************************************************/
+
+#define CODE_COUNT ((int)(sizeof(code_messages) / sizeof(code_messages[0])))
+#define CODE_MAX (CODE_COUNT + 1)
+#define MAX_MESSAGE 128
+#define MAX_SIGNS 1024
+#define MAX_ENTRIES 1024
+
+// interword space in continuous mode and the minimal space in interval mode
+#define WORD_SPACE_SIGNS 7
+
+// letter space and word space within a message, in signs
+#define LETTER_SPACE_SIGNS 3
+#define MESSAGE_SPACE_SIGNS 7
+
+static const char * const code_messages[] = CODE_MESSAGES;
+static const char * const code_names[] = CODE_NAMES;
+
+// international morse code, the elements of the characters
+static const struct
+{
+  char ch;
+  const char *elements;
+} morse[] = {
+  { 'A', ".-" },    { 'B', "-..." },  { 'C', "-.-." },  { 'D', "-.." },
+  { 'E', "." },     { 'F', "..-." },  { 'G', "--." },   { 'H', "...." },
+  { 'I', ".." },    { 'J', ".---" },  { 'K', "-.-" },   { 'L', ".-.." },
+  { 'M', "--" },    { 'N', "-." },    { 'O', "---" },   { 'P', ".--." },
+  { 'Q', "--.-" },  { 'R', ".-." },   { 'S', "..." },   { 'T', "-" },
+  { 'U', "..-" },   { 'V', "...-" },  { 'W', ".--" },   { 'X', "-..-" },
+  { 'Y', "-.--" },  { 'Z', "--.." },
+  { '0', "-----" }, { '1', ".----" }, { '2', "..---" }, { '3', "...--" },
+  { '4', "....-" }, { '5', "....." }, { '6', "-...." }, { '7', "--..." },
+  { '8', "---.." }, { '9', "----." },
+  { '/', "-..-." }, { '?', "..--.." }, { '=', "-...-" }, { ',', "--..--" },
+  { '.', ".-.-.-" },
+};
+
+static const char * const speed_names[2] = { "SLOW", "FAST" };
+static const uint8_t speed_wpm[2] = { CODE_SPEED_SLOW, CODE_SPEED_FAST };
+
+// indexed by the interval length switch: 0 long, 1 short, and the
+// continuous mode
+#define LENGTH_CONTINUOUS 2
+static const char * const length_names[3] = { "long", "short", "cont" };
+static const int length_seconds[2] = { INTERVAL_LONG, INTERVAL_SHORT };
+
+/**** local variables ********************************************************/
+
+// number of codes, with the beacon message
+static int codes = CODE_COUNT;
+
+// beacon message, empty if none
+static char message[MAX_MESSAGE];
+
+// signs of every code: 1 key down, 0 key up
+static struct
+{
+  uint8_t sign[MAX_SIGNS];
+  int length;
+} pattern[CODE_MAX];
+
+// schedule of a word, as it is written to the tables
+static struct
+{
+  uint8_t entry[MAX_ENTRIES];
+  int count;
+  int signs;
+  int ticks;
+} keying[CODE_MAX][2];
+
+// word space and lead-in of every interval length and the continuous mode,
+// every word space is space + rem / mod ticks on the average
+typedef struct
+{
+  int space;
+  int rem;
+  int mod;
+  int lead;
+  int words;
+} SPACING;
+
+static SPACING spacing[CODE_MAX][2][3];
+
+/**** local functions ********************************************************/
+
+/*===========================================================================*/
+/*  Function: code_name                                                      */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - c: code index                                                    */
+/*  Return value:                                                            */
+/*        - name of the code in the tables                                   */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the beacon message is named MSG, the others as in codes.h              */
+/*===========================================================================*/
+static const char *code_name(int c)
+{
+  return c < CODE_COUNT ? code_names[c] : "MSG";
+}
+
+
+/*===========================================================================*/
+/*  Function: morse_char                                                     */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - ch: character                                                    */
+/*  Return value:                                                            */
+/*        - elements of the character, NULL if it has no morse code          */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    looks up a character in the morse code table, lower case letters are   */
+/*    sent as upper case                                                     */
+/*===========================================================================*/
+static const char *morse_char(char ch)
+{
+  size_t i;
+
+  ch = toupper((unsigned char)ch);
+  for (i = 0; i < sizeof(morse) / sizeof(morse[0]); i++)
+    if (morse[i].ch == ch)
+      return morse[i].elements;
+
+  return NULL;
+}
+
+
+/*===========================================================================*/
+/*  Function: encode_message                                                 */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - c: code index                                                    */
+/*        - text: message                                                    */
+/*  Return value:                                                            */
+/*        - 0 on success, -1 if the message can not be encoded               */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    encodes a message into the signs of a code: a dot is one sign key      */
+/*    down, a dash is three, the elements are separated by one sign, the     */
+/*    letters by three and the words of the message by seven signs key up,   */
+/*    the code ends with the last key down sign, the word space after it is  */
+/*    added by the interrupt handler                                         */
+/*===========================================================================*/
+static int encode_message(int c, const char *text)
+{
+  const char *p;
+  const char *elements;
+  int len = 0;
+  int gap = 0;
+
+  for (p = text; *p; p++)
+  {
+    if (*p == ' ')
+    {
+      if (len)
+        gap = MESSAGE_SPACE_SIGNS;
+      continue;
+    }
+
+    if (!(elements = morse_char(*p)))
+    {
+      fprintf(stderr, "gen_keying: no morse code for '%c' in \"%s\"\n", *p, text);
+      return -1;
+    }
+    if (len && gap < LETTER_SPACE_SIGNS)
+      gap = LETTER_SPACE_SIGNS;
+
+    for (; *elements; elements++)
+    {
+      int signs = *elements == '-' ? 3 : 1;
+
+      if (len + gap + signs + 1 > MAX_SIGNS)
+      {
+        fprintf(stderr, "gen_keying: message \"%s\" is too long\n", text);
+        return -1;
+      }
+      while (gap--)
+        pattern[c].sign[len++] = 0;
+      while (signs--)
+        pattern[c].sign[len++] = 1;
+      gap = 1;
+    }
+    gap = 0;
+  }
+
+  if (!len)
+  {
+    fprintf(stderr, "gen_keying: message \"%s\" has no signs\n", text);
+    return -1;
+  }
+  pattern[c].length = len;
+
+  return 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: read_message                                                   */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - file: name of the file                                           */
+/*        - text: buffer of the message                                      */
+/*        - size: size of the buffer                                         */
+/*  Return value:                                                            */
+/*        - 0 on success, -1 on error                                        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    reads the beacon message from the first line of a file, an empty line  */
+/*    means no beacon message                                                */
+/*===========================================================================*/
+static int read_message(const char *file, char *text, int size)
+{
+  FILE *f = fopen(file, "r");
+
+  if (!f)
+  {
+    perror(file);
+    return -1;
+  }
+  if (!fgets(text, size, f))
+    text[0] = 0;
+  fclose(f);
+  text[strcspn(text, "\r\n")] = 0;
+
+  return 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: gcd                                                            */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - a, b: positive numbers                                           */
+/*  Return value:                                                            */
+/*        - greatest common divisor                                          */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    Euclid's algorithm, reduces the fractions of the timing                */
+/*===========================================================================*/
+static long gcd(long a, long b)
+{
+  while (b)
+  {
+    long r = a % b;
+
+    a = b;
+    b = r;
+  }
+
+  return a;
+}
+
+
+/*===========================================================================*/
+/*  Function: sign_edge                                                      */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - s: speed index                                                   */
+/*        - pos: sign index                                                  */
+/*  Return value:                                                            */
+/*        - time from the start of the word in ticks                         */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    start of a sign, rounded to the nearest tick of its exact time, the    */
+/*    length of every element is the difference of its edges, so the         */
+/*    rounding errors do not add up within the word                          */
+/*===========================================================================*/
+static int sign_edge(int s, int pos)
+{
+  long num = (long)pos * SIGN_TICKS_NUM;
+  long den = SIGN_TICKS_DEN(speed_wpm[s]);
+
+  return (2 * num + den) / (2 * den);
+}
+
+
+/*===========================================================================*/
+/*  Function: add_run                                                        */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - c: code index                                                    */
+/*        - s: speed index                                                   */
+/*        - level: key level                                                 */
+/*        - ticks: length of the element                                     */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    adds the entries of one element, elements longer than the length       */
+/*    field of an entry are split into several entries of the same level     */
+/*===========================================================================*/
+static void add_run(int c, int s, uint8_t level, int ticks)
+{
+  while (ticks > 0)
+  {
+    int len = ticks > KEYING_TICKS ? KEYING_TICKS : ticks;
+
+    if (keying[c][s].count >= MAX_ENTRIES - 1)
+    {
+      fprintf(stderr, "gen_keying: schedule of %s is too long\n", code_name(c));
+      exit(1);
+    }
+    keying[c][s].entry[keying[c][s].count++] = (level ? KEYING_LEVEL : 0) | len;
+    ticks -= len;
+  }
+}
+
+
+/*===========================================================================*/
+/*  Function: build_keying                                                   */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - c: code index                                                    */
+/*        - s: speed index                                                   */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    builds the schedule of a single word of a code at one speed            */
+/*===========================================================================*/
+static void build_keying(int c, int s)
+{
+  const uint8_t *sign = pattern[c].sign;
+  int len = pattern[c].length;
+  int level = 1;
+  int start = 0;
+  int pos;
+
+  for (pos = 0; pos < len; pos++)
+  {
+    if (sign[pos] != level)
+    {
+      add_run(c, s, level, sign_edge(s, pos) - sign_edge(s, start));
+      level = !level;
+      start = pos;
+    }
+  }
+  add_run(c, s, level, sign_edge(s, len) - sign_edge(s, start));
+
+  keying[c][s].signs = len;
+  keying[c][s].ticks = sign_edge(s, len);
+}
+
+
+/*===========================================================================*/
+/*  Function: print_keying                                                   */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - c: code index                                                    */
+/*        - s: speed index                                                   */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the schedule table of a single word of a code at one speed      */
+/*===========================================================================*/
+static void print_keying(int c, int s)
+{
+  int i;
+
+  printf("// %s at %d WPM: %d signs, %d ticks\n", code_name(c), speed_wpm[s],
+         keying[c][s].signs, keying[c][s].ticks);
+  printf("const PROGMEM uint8_t KEYING_%s_%s[] = {", code_name(c), speed_names[s]);
+  for (i = 0; i < keying[c][s].count; i++)
+    printf(" 0x%02x,", keying[c][s].entry[i]);
+  printf(" 0 }; // %d elements\n\n", keying[c][s].count);
+}
+
+
+#ifndef USE_FIXED
+/*===========================================================================*/
+/*  Function: print_spacing                                                  */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - type: element type of the table                                  */
+/*        - name: name of the table                                          */
+/*        - field: offset of the value in SPACING                            */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints one of the word space tables, for every code and speed the long */
+/*    and short interval and the continuous mode                             */
+/*===========================================================================*/
+static void print_spacing(const char *type, const char *name, size_t field)
+{
+  int c, s, l;
+
+  printf("const PROGMEM %s %s[KEYING_CODES][2][3] = {\n", type, name);
+  for (c = 0; c < codes; c++)
+  {
+    printf("  {");
+    for (s = 0; s < 2; s++)
+    {
+      printf(" {");
+      for (l = 0; l < 3; l++)
+        printf(" %d%s", *(const int *)((const char *)&spacing[c][s][l] + field),
+               l < 2 ? "," : "");
+      printf(" }%s", s < 1 ? "," : "");
+    }
+    printf(" }, // %s\n", code_name(c));
+  }
+  printf("};\n\n");
+}
+#endif
+
+
+/*===========================================================================*/
+/*  Function: compute_space                                                  */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - c: code index                                                    */
+/*        - s: speed index                                                   */
+/*        - l: interval length index                                         */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    computes the word space in ticks for an enable period: as many whole   */
+/*    words are sent as possible with at least the normal word space between */
+/*    them, the space is then stretched to fill the period, so that the last */
+/*    word ends a normal word space before the TXOFF tone                    */
+/*    the remainder of the division is spread over the word spaces, a single */
+/*    word is preceded by a silent lead-in instead                           */
+/*===========================================================================*/
+static void compute_space(int c, int s, int l)
+{
+  int ws = sign_edge(s, WORD_SPACE_SIGNS);
+  int word = keying[c][s].ticks;
+  int avail = INTERVAL_COUNT(length_seconds[l]) - TXOFF_TICKS - ws;
+  int words = (avail + ws) / (word + ws);
+
+  spacing[c][s][l].words = words;
+  spacing[c][s][l].rem = 0;
+  spacing[c][s][l].mod = 1;
+  spacing[c][s][l].lead = 0;
+  if (words > 1)
+  {
+    spacing[c][s][l].space = (avail - words * word) / (words - 1);
+    spacing[c][s][l].rem = (avail - words * word) % (words - 1);
+    spacing[c][s][l].mod = words - 1;
+  }
+  else
+  {
+    spacing[c][s][l].space = ws;
+    spacing[c][s][l].lead = words ? avail - word : 0;
+  }
+}
+
+
+/*===========================================================================*/
+/*  Function: compute_continuous                                             */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - c: code index                                                    */
+/*        - s: speed index                                                   */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    computes the word space in ticks for the continuous mode: a word and   */
+/*    the normal word space last an exact fraction of ticks, the word space  */
+/*    is its whole part minus the word, the fraction is given by the         */
+/*    remainder and the divisor, so the words follow each other without      */
+/*    drift                                                                  */
+/*===========================================================================*/
+static void compute_continuous(int c, int s)
+{
+  long num = (long)(keying[c][s].signs + WORD_SPACE_SIGNS) * SIGN_TICKS_NUM;
+  long den = SIGN_TICKS_DEN(speed_wpm[s]);
+  long div = gcd(num, den);
+
+  num /= div;
+  den /= div;
+  spacing[c][s][LENGTH_CONTINUOUS].space = num / den - keying[c][s].ticks;
+  spacing[c][s][LENGTH_CONTINUOUS].rem = num % den;
+  spacing[c][s][LENGTH_CONTINUOUS].mod = den;
+  spacing[c][s][LENGTH_CONTINUOUS].lead = 0;
+  spacing[c][s][LENGTH_CONTINUOUS].words = 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: verify_window                                                  */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - c: code index                                                    */
+/*        - s: speed index                                                   */
+/*        - l: interval length index                                         */
+/*        - report: report file                                              */
+/*  Return value:                                                            */
+/*        - number of errors found                                           */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    runs the schedule through one enable period the same way as the timer  */
+/*    interrupt does, and checks that only whole words are sent before the   */
+/*    TXOFF tone and that the last one ends right before it                  */
+/*===========================================================================*/
+static int verify_window(int c, int s, int l, FILE *report)
+{
+  int period = INTERVAL_COUNT(length_seconds[l]);
+  int txoff = period - TXOFF_TICKS;
+  int ws = sign_edge(s, WORD_SPACE_SIGNS);
+  int avail = txoff - ws;
+  int space = spacing[c][s][l].space;
+  int rem = spacing[c][s][l].rem;
+  int mod = spacing[c][s][l].mod;
+  int acc = 0;
+  int ticks = spacing[c][s][l].lead + 1;
+  int ptr = 0;
+  int key = 0;
+  int started = 0;
+  int ended = 0;
+  int last_key = -1;
+  int errors = 0;
+  int t;
+
+  for (t = 0; t < period; t++)
+  {
+    if (!--ticks)
+    {
+      uint8_t element = ptr < keying[c][s].count ? keying[c][s].entry[ptr] : 0;
+
+      if (!ptr && t < avail)
+        started++;
+      ptr++;
+      if (element)
+      {
+        ticks = element & KEYING_TICKS;
+        key = (element & KEYING_LEVEL) != 0;
+      }
+      else
+      {
+        if (t <= avail)
+          ended++;
+        ticks = space;
+        acc += rem;
+        if (acc >= mod)
+        {
+          acc -= mod;
+          ticks++;
+        }
+        ptr = 0;
+        key = 0;
+      }
+    }
+    if (key && t < txoff)
+      last_key = t;
+  }
+
+  if (started != spacing[c][s][l].words || ended != started)
+    errors++;
+  if (last_key != avail - 1)
+    errors++;
+  if (space < ws || space > UINT16_MAX)
+    errors++;
+  if (rem >= mod || mod > UINT8_MAX || spacing[c][s][l].lead > UINT8_MAX)
+    errors++;
+
+  // a beacon message longer than the enable period is cut by the TXOFF
+  // tone, it is meant for the continuous mode, so it is not an error
+  if (c >= CODE_COUNT && !spacing[c][s][l].words)
+  {
+    fprintf(stderr, "gen_keying: warning: beacon message at %d WPM does not fit"
+            " in the %s enable period\n", speed_wpm[s], length_names[l]);
+    errors = 0;
+  }
+
+  fprintf(report, "%-4s %2d WPM %-5s  %5d %5d %3d %5d %3d/%-3d %4d %3d/%-3d %5d %5d  %s\n",
+          code_name(c), speed_wpm[s], length_names[l],
+          keying[c][s].ticks, period, spacing[c][s][l].words,
+          space, rem, mod, spacing[c][s][l].lead, started, ended, last_key + 1, txoff,
+          errors ? "FAIL" : spacing[c][s][l].words ? "ok" : "cut");
+
+  return errors;
+}
+
+
+/*===========================================================================*/
+/*  Function: verify_continuous                                              */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - c: code index                                                    */
+/*        - s: speed index                                                   */
+/*        - report: report file                                              */
+/*  Return value:                                                            */
+/*        - number of errors found                                           */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    runs the schedule in continuous mode the same way as the timer         */
+/*    interrupt does, until the remainder of the word space returns to its   */
+/*    start, and checks that every word starts at the tick of its exact time */
+/*===========================================================================*/
+static int verify_continuous(int c, int s, FILE *report)
+{
+  const int l = LENGTH_CONTINUOUS;
+  long num = (long)(keying[c][s].signs + WORD_SPACE_SIGNS) * SIGN_TICKS_NUM;
+  long den = SIGN_TICKS_DEN(speed_wpm[s]);
+  int space = spacing[c][s][l].space;
+  int rem = spacing[c][s][l].rem;
+  int mod = spacing[c][s][l].mod;
+  int acc = 0;
+  int ticks = 1;
+  int ptr = 0;
+  int words = 0;
+  int late = 0;
+  int errors = 0;
+  long t;
+
+  for (t = 0; words <= mod; t++)
+  {
+    if (!--ticks)
+    {
+      uint8_t element = ptr < keying[c][s].count ? keying[c][s].entry[ptr] : 0;
+
+      if (!ptr)
+      {
+        // the first word starts at the first tick
+        if (t != words * num / den && late++ < 1)
+          fprintf(report, "%-4s %2d WPM: word %d starts at %ld instead of %ld\n",
+                  code_name(c), speed_wpm[s], words, t, words * num / den);
+        words++;
+      }
+      ptr++;
+      if (element)
+      {
+        ticks = element & KEYING_TICKS;
+      }
+      else
+      {
+        ticks = space;
+        acc += rem;
+        if (acc >= mod)
+        {
+          acc -= mod;
+          ticks++;
+        }
+        ptr = 0;
+      }
+    }
+  }
+
+  if (late)
+    errors++;
+  if (SIGN_TICKS_NUM < SIGN_TICKS_DEN(speed_wpm[s]))
+    errors++;
+  if (space < sign_edge(s, WORD_SPACE_SIGNS) - 1 || space > UINT16_MAX)
+    errors++;
+  if (rem >= mod || mod > UINT8_MAX)
+    errors++;
+
+  fprintf(report, "%-4s %2d WPM %-5s  %5d %5ld/%-3ld %5d %3d/%-3d %4d  %s\n",
+          code_name(c), speed_wpm[s], length_names[l],
+          keying[c][s].ticks, num / gcd(num, den), den / gcd(num, den),
+          space, rem, mod, words, errors ? "FAIL" : "ok");
+
+  return errors;
+}
+
+
+/**** global functions *******************************************************/
+
+/*===========================================================================*/
+/*  Function: main                                                           */
+/*  Module:   gen_keying                                                     */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - argc, argv: command line, the report file name and the file of   */
+/*          the beacon message are optional                                  */
+/*  Return value:                                                            */
+/*        - exit status                                                      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the generated header to the standard output, and the            */
+/*    verification report to the given file                                  */
+/*    fails if any of the enable periods can not be filled with whole words  */
+/*===========================================================================*/
+int main(int argc, char *argv[])
+{
+  FILE *report = stderr;
+  int errors = 0;
+  int c, s, l, n;
+
+  if (argc > 1 && !(report = fopen(argv[1], "w")))
+  {
+    perror(argv[1]);
+    return 1;
+  }
+  if (argc > 2 && read_message(argv[2], message, sizeof(message)))
+    return 1;
+
+  for (c = 0; c < CODE_COUNT; c++)
+    if (encode_message(c, code_messages[c]))
+      return 1;
+  if (message[0])
+  {
+    if (encode_message(codes, message))
+      return 1;
+    codes++;
+  }
+
+  for (c = 0; c < codes; c++)
+    for (s = 0; s < 2; s++)
+    {
+      build_keying(c, s);
+      for (l = 0; l < 2; l++)
+        compute_space(c, s, l);
+      compute_continuous(c, s);
+    }
+
+  printf("// keying.h: generated by gen_keying from codes.h and config.h, do not edit\n\n");
+  printf("#ifndef __KEYING_H__\n#define __KEYING_H__\n\n");
+  printf("// keying schedule of a single word: one entry for every element,\n");
+  printf("// key level (KEYING_LEVEL) and length in timer ticks (KEYING_TICKS),\n");
+  printf("// the word is closed by a 0 entry\n\n");
+
+#ifdef USE_FIXED
+  // only the schedule of the fixed configuration, its word space and
+  // lead-in are constants
+  c = FIXED_CODE;
+  s = FIXED_SPEED;
+  l = FIXED_FOXES ? FIXED_LENGTH : LENGTH_CONTINUOUS;
+  if (c >= codes)
+  {
+    fprintf(stderr, "gen_keying: the fixed code has no beacon message\n");
+    return 1;
+  }
+  print_keying(c, s);
+  printf("// fixed configuration: %s at %d WPM, %s\n", code_name(c), speed_wpm[s],
+         length_names[l]);
+  printf("#define KEYING_FIXED KEYING_%s_%s\n", code_name(c), speed_names[s]);
+  printf("#define KEYING_FIXED_SPACE %d\n", spacing[c][s][l].space);
+  printf("#define KEYING_FIXED_SPACE_REM %d\n", spacing[c][s][l].rem);
+  printf("#define KEYING_FIXED_SPACE_MOD %d\n", spacing[c][s][l].mod);
+  printf("#define KEYING_FIXED_LEAD %d\n\n", spacing[c][s][l].lead);
+  printf("#endif /*__KEYING_H__*/\n");
+#else
+  for (c = 0; c < codes; c++)
+    for (s = 0; s < 2; s++)
+      print_keying(c, s);
+
+  printf("#define KEYING_CODES %d\n\n", codes);
+  if (message[0])
+  {
+    printf("// beacon message \"%s\", selected by the code switches\n", message);
+    printf("#define KEYING_MESSAGE %d\n\n", CODE_COUNT);
+  }
+  printf("// schedule tables indexed by DIP_CODE_VALUE and the speed switch\n");
+  printf("const uint8_t * const keying_table[KEYING_CODES][2] PROGMEM = {\n");
+  for (c = 0; c < codes; c++)
+    printf("  { KEYING_%s_SLOW, KEYING_%s_FAST },\n", code_name(c), code_name(c));
+  printf("};\n\n");
+
+  printf("// word space and silent lead-in in ticks, indexed by DIP_CODE_VALUE,\n");
+  printf("// the speed and the interval length switch, or KEYING_CONTINUOUS,\n");
+  printf("// in interval mode the last whole word of an enable period ends a word\n");
+  printf("// space before TXOFF, every word space is extended by one tick when the\n");
+  printf("// sum of the remainders reaches the divisor\n");
+  printf("#define KEYING_CONTINUOUS %d\n\n", LENGTH_CONTINUOUS);
+  print_spacing("uint16_t", "keying_space", offsetof(SPACING, space));
+  print_spacing("uint8_t", "keying_space_rem", offsetof(SPACING, rem));
+  print_spacing("uint8_t", "keying_space_mod", offsetof(SPACING, mod));
+  print_spacing("uint8_t", "keying_lead", offsetof(SPACING, lead));
+  printf("#endif /*__KEYING_H__*/\n");
+#endif
+
+  // verification report
+  fprintf(report, "keying schedule verification, all lengths in ticks of %d ms\n\n",
+          1000 / TICKS_PER_SECOND);
+  fprintf(report, "code speed  length   word   period words space rem/mod lead"
+                  " start/end  end  TXOFF\n");
+  for (c = 0; c < codes; c++)
+    for (s = 0; s < 2; s++)
+      for (l = 0; l < 2; l++)
+        errors += verify_window(c, s, l, report);
+
+  // continuous mode, the words follow each other at the exact word length
+  // and word space
+  fprintf(report, "\ncode speed  length   word     cycle space rem/mod words\n");
+  for (c = 0; c < codes; c++)
+    for (s = 0; s < 2; s++)
+      errors += verify_continuous(c, s, report);
+
+  // the word space does not depend on the number of foxes, the cycle
+  // length shall fit in the 16 bit interval counter
+  fprintf(report, "\ninterval count  long cycle  short cycle\n");
+  for (n = 2; n <= 5; n++)
+  {
+    long cycle_long = (long)n * INTERVAL_COUNT(INTERVAL_LONG);
+    long cycle_short = (long)n * INTERVAL_COUNT(INTERVAL_SHORT);
+
+    fprintf(report, "%14d  %10ld  %11ld  %s\n", n, cycle_long, cycle_short,
+            cycle_long <= UINT16_MAX ? "ok" : "FAIL");
+    if (cycle_long > UINT16_MAX)
+      errors++;
+  }
+  fprintf(report, "\n%d error(s)\n", errors);
+
+  if (report != stderr)
+    fclose(report);
+
+  if (errors)
+    fprintf(stderr, "gen_keying: %d enable period(s) failed the verification\n", errors);
+
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,464 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: gen_schedule.c                                                  */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - build time generator of the event schedule                            */
+/*     converts the windows given by the SCHEDULE make variable into the     */
+/*     initializer of the schedule table, the times in ticks since the       */
+/*     power-on, the settings as the values of the DIP switches              */
+/*   - the windows are checked: they shall follow each other in time, only   */
+/*     the last one may be left without an end                               */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - first implementation                                      */
+/*                                                                           */
+/*****************************************************************************/
+
+/**** include files **********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+// the schedule settings of config.h, the generator runs for every build,
+// an option which can not be combined with the schedule is left out
+#ifndef USE_SCHEDULE
+#define USE_SCHEDULE
+#undef USE_RESUME
+#undef USE_FIXED
+#endif
+#include "config.h"
+#include "codes.h"
+
+/**** local function prototypes **********************************************/
+static int read_line(const char *file, char *text, int size);
+static int parse_time(const char *text, long *seconds);
+static int parse_code(const char *text, int *code);
+static int parse_speed(const char *text, int *speed);
+static int parse_freq(const char *text, int *freq);
+static int parse_window(char *text, int w);
+static void print_time(long seconds);
+static void print_setting(int value);
+
+/**** constants **************************************************************/
+
+#define CODE_COUNT ((int)(sizeof(code_names) / sizeof(code_names[0])))
+#define MAX_TEXT 1024
+
+// a window with no end
+#define NO_END (-1L)
+
+static const char * const code_names[] = CODE_NAMES;
+static const char * const speed_names[2] = { "slow", "fast" };
+
+/**** local variables ********************************************************/
+
+// the beacon message is selected by the code value after the codes
+static int message;
+
+// windows in seconds since the power-on, the settings are SCHED_DIP when
+// left to the switches
+static struct
+{
+  long start;
+  long end;
+  int code;
+  int speed;
+  int freq;
+} window[SCHED_MAX_WINDOWS];
+
+static int windows;
+
+/**** local functions ********************************************************/
+
+/*===========================================================================*/
+/*  Function: read_line                                                      */
+/*  Module:   gen_schedule                                                   */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - file: name of the file                                           */
+/*        - text: buffer of the line                                         */
+/*        - size: size of the buffer                                         */
+/*  Return value:                                                            */
+/*        - 0 on success, -1 on error                                        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    reads the first line of a file, as written by the makefile             */
+/*===========================================================================*/
+static int read_line(const char *file, char *text, int size)
+{
+  FILE *f = fopen(file, "r");
+
+  if (!f)
+  {
+    perror(file);
+    return -1;
+  }
+  if (!fgets(text, size, f))
+    text[0] = 0;
+  fclose(f);
+  text[strcspn(text, "\r\n")] = 0;
+
+  return 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: parse_time                                                     */
+/*  Module:   gen_schedule                                                   */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - text: time as h:mm or h:mm:ss                                    */
+/*        - seconds: the time in seconds                                     */
+/*  Return value:                                                            */
+/*        - 0 on success, -1 if the time is not valid                        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the hours are not limited, the minutes and seconds are two digits      */
+/*===========================================================================*/
+static int parse_time(const char *text, long *seconds)
+{
+  long h;
+  int m, s = 0;
+  int n = 0;
+  int k = 0;
+
+  if (!isdigit((unsigned char)text[0]) || sscanf(text, "%ld:%2d%n", &h, &m, &n) != 2)
+    return -1;
+  if (text[n] == ':')
+  {
+    if (sscanf(text + n, ":%2d%n", &s, &k) != 1)
+      return -1;
+    n += k;
+  }
+  if (text[n] || m < 0 || m > 59 || s < 0 || s > 59)
+    return -1;
+
+  *seconds = (h * 60 + m) * 60 + s;
+
+  return 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: parse_code                                                     */
+/*  Module:   gen_schedule                                                   */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - text: name of the code, - or empty for the switches              */
+/*        - code: the code value                                             */
+/*  Return value:                                                            */
+/*        - 0 on success, -1 if the code is not known                        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the names of codes.h, MSG for the beacon message if there is one       */
+/*===========================================================================*/
+static int parse_code(const char *text, int *code)
+{
+  int c;
+
+  *code = SCHED_DIP;
+  if (!text[0] || !strcmp(text, "-"))
+    return 0;
+
+  for (c = 0; c < CODE_COUNT; c++)
+    if (!strcasecmp(text, code_names[c]))
+    {
+      *code = c;
+      return 0;
+    }
+  if (message && !strcasecmp(text, "MSG"))
+  {
+    *code = CODE_COUNT;
+    return 0;
+  }
+
+  return -1;
+}
+
+
+/*===========================================================================*/
+/*  Function: parse_speed                                                    */
+/*  Module:   gen_schedule                                                   */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - text: slow or fast, - or empty for the switch                    */
+/*        - speed: index of the speed                                        */
+/*  Return value:                                                            */
+/*        - 0 on success, -1 if the speed is not known                       */
+/*===========================================================================*/
+static int parse_speed(const char *text, int *speed)
+{
+  int s;
+
+  *speed = SCHED_DIP;
+  if (!text[0] || !strcmp(text, "-"))
+    return 0;
+
+  for (s = 0; s < 2; s++)
+    if (!strcasecmp(text, speed_names[s]))
+    {
+      *speed = s;
+      return 0;
+    }
+
+  return -1;
+}
+
+
+/*===========================================================================*/
+/*  Function: parse_freq                                                     */
+/*  Module:   gen_schedule                                                   */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - text: frequency setting 0-7, - or empty for the switches         */
+/*        - freq: the frequency setting                                      */
+/*  Return value:                                                            */
+/*        - 0 on success, -1 if the setting is not valid                     */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    only the boards with programmable frequency have the setting           */
+/*===========================================================================*/
+static int parse_freq(const char *text, int *freq)
+{
+  *freq = SCHED_DIP;
+  if (!text[0] || !strcmp(text, "-"))
+    return 0;
+
+#ifdef USE_PROG_FREQ
+  if (text[0] >= '0' && text[0] < '0' + (1 << DIP_FREQ_BITS) && !text[1])
+  {
+    *freq = text[0] - '0';
+    return 0;
+  }
+#endif
+
+  return -1;
+}
+
+
+/*===========================================================================*/
+/*  Function: parse_window                                                   */
+/*  Module:   gen_schedule                                                   */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - text: window as start-end/code/speed/freq, modified              */
+/*        - w: index of the window                                           */
+/*  Return value:                                                            */
+/*        - 0 on success, -1 on error                                        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the end and the settings are optional, an error is reported with the   */
+/*    text of the window                                                     */
+/*===========================================================================*/
+static int parse_window(char *text, int w)
+{
+  char *field[5] = { text, "", "", "", "" };
+  char *p;
+  int f;
+
+  // start-end, then the settings separated by /
+  p = strchr(text, '-');
+  if (!p)
+  {
+    fprintf(stderr, "gen_schedule: window %s has no end time\n", text);
+    return -1;
+  }
+  *p++ = 0;
+  field[1] = p;
+  for (f = 2; f < 5 && (p = strchr(p, '/')); f++)
+  {
+    *p++ = 0;
+    field[f] = p;
+  }
+  if (p && strchr(p, '/'))
+  {
+    fprintf(stderr, "gen_schedule: window %s-%s has too many settings\n",
+            field[0], field[1]);
+    return -1;
+  }
+
+  if (parse_time(field[0], &window[w].start) ||
+      (field[1][0] && parse_time(field[1], &window[w].end)))
+  {
+    fprintf(stderr, "gen_schedule: window %s-%s has an invalid time\n", field[0], field[1]);
+    return -1;
+  }
+  if (!field[1][0])
+    window[w].end = NO_END;
+
+  if (parse_code(field[2], &window[w].code))
+  {
+    fprintf(stderr, "gen_schedule: unknown code %s\n", field[2]);
+    return -1;
+  }
+  if (parse_speed(field[3], &window[w].speed))
+  {
+    fprintf(stderr, "gen_schedule: unknown speed %s\n", field[3]);
+    return -1;
+  }
+  if (parse_freq(field[4], &window[w].freq))
+  {
+    fprintf(stderr, "gen_schedule: invalid frequency setting %s\n", field[4]);
+    return -1;
+  }
+
+  return 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: print_time                                                     */
+/*  Module:   gen_schedule                                                   */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - seconds: time since the power-on                                 */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+static void print_time(long seconds)
+{
+  printf("%ld:%02ld:%02ld", seconds / 3600, seconds / 60 % 60, seconds % 60);
+}
+
+
+/*===========================================================================*/
+/*  Function: print_setting                                                  */
+/*  Module:   gen_schedule                                                   */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - value: value of a setting                                        */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+static void print_setting(int value)
+{
+  if (value == SCHED_DIP)
+    printf(", SCHED_DIP");
+  else
+    printf(", %d", value);
+}
+
+
+/**** global functions *******************************************************/
+
+/*===========================================================================*/
+/*  Function: main                                                           */
+/*  Module:   gen_schedule                                                   */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - argc, argv: command line, the file of the beacon message and the */
+/*          file of the schedule                                             */
+/*  Return value:                                                            */
+/*        - exit status                                                      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the generated header to the standard output                     */
+/*    fails if a window can not be parsed, or the windows do not follow each */
+/*    other in time                                                          */
+/*===========================================================================*/
+int main(int argc, char *argv[])
+{
+  char text[MAX_TEXT];
+  char *p;
+  int w;
+
+  if (argc != 3)
+  {
+    fprintf(stderr, "usage: %s message-file schedule-file\n", argv[0]);
+    return 1;
+  }
+  if (read_line(argv[1], text, sizeof(text)))
+    return 1;
+  message = text[0] != 0;
+  if (read_line(argv[2], text, sizeof(text)))
+    return 1;
+
+  for (p = strtok(text, " \t"); p; p = strtok(NULL, " \t"))
+  {
+    if (windows == SCHED_MAX_WINDOWS)
+    {
+      fprintf(stderr, "gen_schedule: more than %d windows\n", SCHED_MAX_WINDOWS);
+      return 1;
+    }
+    if (parse_window(p, windows))
+      return 1;
+    windows++;
+  }
+
+  // a single window from the power-on, set by the switches
+  if (!windows)
+  {
+    window[0].start = 0;
+    window[0].end = NO_END;
+    window[0].code = SCHED_DIP;
+    window[0].speed = SCHED_DIP;
+    window[0].freq = SCHED_DIP;
+    windows = 1;
+  }
+
+  for (w = 0; w < windows; w++)
+  {
+    if (window[w].end == NO_END && w != windows - 1)
+    {
+      fprintf(stderr, "gen_schedule: only the last window can be left without an end\n");
+      return 1;
+    }
+    if (window[w].end != NO_END && window[w].end <= window[w].start)
+    {
+      fprintf(stderr, "gen_schedule: window %d ends before it starts\n", w + 1);
+      return 1;
+    }
+    if (w && window[w].start < window[w - 1].end)
+    {
+      fprintf(stderr, "gen_schedule: window %d starts before window %d ends\n", w + 1, w);
+      return 1;
+    }
+    if ((window[w].end == NO_END ? window[w].start : window[w].end) >=
+        (long)(SCHED_FOREVER / TICKS_PER_SECOND))
+    {
+      fprintf(stderr, "gen_schedule: window %d is out of the schedule clock\n", w + 1);
+      return 1;
+    }
+  }
+
+  printf("// schedule.h: generated by gen_schedule from the SCHEDULE make variable, do not edit\n\n");
+  printf("#ifndef __SCHEDULE_H__\n#define __SCHEDULE_H__\n\n");
+  printf("// windows of the event schedule: start and end in ticks since the\n");
+  printf("// power-on, code, speed and frequency, SCHED_DIP if set by the switches\n");
+  printf("#define SCHEDULE_COUNT %d\n\n", windows);
+  printf("#define SCHEDULE_WINDOWS \\\n  { \\\n");
+  for (w = 0; w < windows; w++)
+  {
+    printf("    { %luUL, ", (unsigned long)window[w].start * TICKS_PER_SECOND);
+    if (window[w].end == NO_END)
+      printf("SCHED_FOREVER");
+    else
+      printf("%luUL", (unsigned long)window[w].end * TICKS_PER_SECOND);
+    print_setting(window[w].code);
+    print_setting(window[w].speed);
+    print_setting(window[w].freq);
+    printf(" }, /* ");
+    print_time(window[w].start);
+    printf("-");
+    if (window[w].end != NO_END)
+      print_time(window[w].end);
+    printf(" */ \\\n");
+  }
+  printf("  }\n\n");
+  printf("#endif /*__SCHEDULE_H__*/\n");
+
+  return 0;
+}
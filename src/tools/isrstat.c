@@ -0,0 +1,921 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: isrstat.c                                                       */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - static analysis of the firmware listing for the benchmark             */
+/*     reads the extended listing (avr-objdump -h -S) of a build, and        */
+/*     reports the flash and RAM usage, the best and worst case cycle count  */
+/*     of every interrupt handler, the cycles until its first write of the   */
+/*     output port, or of every port given, and the peak stack depth         */
+/*   - compares a report with a baseline, and fails on any regression        */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - first implementation                                      */
+/*                                                                           */
+/*****************************************************************************/
+
+/**** include files **********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**** local types ************************************************************/
+
+// one instruction of the listing
+typedef struct
+{
+  long addr;
+  int size;
+  char mnem[8];
+  char ops[48];
+  long target;
+  int stack;
+} INSN;
+
+// result of the analysis from an instruction to the return of its function
+typedef struct
+{
+  long best;
+  long worst;
+  long port_best;
+  long port_worst;
+  int stack;
+  int loop;
+  int indirect;
+} RESULT;
+
+/**** local function prototypes **********************************************/
+static int read_symbols(const char *file);
+static int read_listing(const char *file);
+static int find_insn(long addr);
+static int insn_is(const INSN *in, const char *mnem);
+static int reg_operand(const INSN *in, int pos);
+static long num_operand(const INSN *in, int pos);
+static void find_frames(void);
+static long min_path(long a, long b);
+static long max_path(long a, long b);
+static RESULT analyze(int i);
+static RESULT analyze_addr(long addr, int p);
+static void report(const char *name);
+static int compare(const char *baseline, const char *current);
+
+/**** constants **************************************************************/
+
+#define MAX_INSNS 16384
+#define MAX_FUNCS 1024
+#define MAX_VECTORS 64
+#define MAX_LINES 1024
+#define NAME_LEN 64
+#define MAX_PORTS 4
+
+// I/O addresses of the stack pointer
+#define IO_SPL 0x3D
+#define IO_SPH 0x3E
+
+// hardware part of the interrupt entry: the response pushes the program
+// counter, and the vector is a relative jump
+#define ISR_RESPONSE_CYCLES 4
+#define VECTOR_JUMP_CYCLES 2
+
+// no path to the port write
+#define NO_PATH -1L
+
+/**** local variables ********************************************************/
+
+static INSN insn[MAX_INSNS];
+static int insns;
+
+static struct
+{
+  long addr;
+  char name[NAME_LEN];
+} func[MAX_FUNCS];
+static int funcs;
+
+// interrupt vector names from the device header, indexed by the number
+static char vector_name[MAX_VECTORS][NAME_LEN];
+
+// device parameters from the device header, the ports whose first write
+// is timed, and the one of the analysis
+static long port_addr[MAX_PORTS] = { -1, -1, -1, -1 };
+static long ram_start = -1;
+static long ram_end = -1;
+static char port_name[MAX_PORTS][NAME_LEN] = { "PORTB" };
+static int ports;
+static int port;
+
+// section sizes
+static long size_text;
+static long size_data;
+static long size_bss;
+static long size_noinit;
+
+// memory of the analysis, indexed by the instruction
+static RESULT memo[MAX_INSNS];
+static char state[MAX_INSNS];
+
+#define STATE_NEW 0
+#define STATE_BUSY 1
+#define STATE_DONE 2
+
+/**** local functions ********************************************************/
+
+/*===========================================================================*/
+/*  Function: read_symbols                                                   */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - file: macro definitions of the device header (gcc -dM -E)        */
+/*  Return value:                                                            */
+/*        - 0 on success, -1 on error                                        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    reads the interrupt vector names, the address of the output port and   */
+/*    the RAM limits of the device                                           */
+/*===========================================================================*/
+static int read_symbols(const char *file)
+{
+  FILE *f = fopen(file, "r");
+  char line[256];
+  char name[NAME_LEN];
+  char port_def[MAX_PORTS][NAME_LEN + 32];
+  int num;
+  int p;
+  long value;
+
+  if (!f)
+  {
+    perror(file);
+    return -1;
+  }
+
+  for (p = 0; p < ports; p++)
+    snprintf(port_def[p], sizeof(port_def[p]), "#define %s _SFR_IO8(%%lx)", port_name[p]);
+  while (fgets(line, sizeof(line), f))
+  {
+    if (sscanf(line, "#define %63s _VECTOR(%d)", name, &num) == 2 &&
+        num >= 0 && num < MAX_VECTORS)
+    {
+      size_t len = strlen(name);
+
+      // the _vect suffix is left out of the report
+      if (len > 5 && !strcmp(name + len - 5, "_vect"))
+      {
+        name[len - 5] = 0;
+        strcpy(vector_name[num], name);
+      }
+    }
+    else if (sscanf(line, "#define RAMSTART (%lx)", &value) == 1 ||
+             sscanf(line, "#define RAMSTART %lx", &value) == 1)
+      ram_start = value;
+    else if (sscanf(line, "#define RAMEND %lx", &value) == 1)
+      ram_end = value;
+    else
+    {
+      for (p = 0; p < ports; p++)
+        if (sscanf(line, port_def[p], &value) == 1)
+          port_addr[p] = value;
+    }
+  }
+  fclose(f);
+
+  return 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: read_listing                                                   */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - file: extended listing                                           */
+/*  Return value:                                                            */
+/*        - 0 on success, -1 on error                                        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    reads the section sizes, the function labels and the instructions,     */
+/*    the source lines of the listing are skipped                            */
+/*    the target of the jumps and calls is taken from the comment, where     */
+/*    the disassembler writes the absolute address                           */
+/*===========================================================================*/
+static int read_listing(const char *file)
+{
+  FILE *f = fopen(file, "r");
+  char line[512];
+  int code = 0;
+
+  if (!f)
+  {
+    perror(file);
+    return -1;
+  }
+
+  while (fgets(line, sizeof(line), f))
+  {
+    char name[NAME_LEN];
+    unsigned long addr, size;
+    int idx, pos;
+
+    // section table: index, name and size
+    if (sscanf(line, " %d %63s %lx", &idx, name, &size) == 3 && name[0] == '.')
+    {
+      if (!strcmp(name, ".text"))
+        size_text = size;
+      else if (!strcmp(name, ".data"))
+        size_data = size;
+      else if (!strcmp(name, ".bss"))
+        size_bss = size;
+      else if (!strcmp(name, ".noinit"))
+        size_noinit = size;
+      continue;
+    }
+
+    if (!strncmp(line, "Disassembly of section", 22))
+    {
+      code = strstr(line, ".text") != NULL;
+      continue;
+    }
+    if (!code)
+      continue;
+
+    // function label: address and <name>:
+    if (sscanf(line, "%lx <%63[^>]>:", &addr, name) == 2)
+    {
+      if (funcs < MAX_FUNCS)
+      {
+        func[funcs].addr = addr;
+        strcpy(func[funcs].name, name);
+        funcs++;
+      }
+      continue;
+    }
+
+    // instruction: address: bytes <tab> mnemonic <tab> operands ; comment
+    if (sscanf(line, " %lx:%n", &addr, &pos) == 1 && line[pos] == '\t')
+    {
+      INSN *in = &insn[insns];
+      char *p = line + pos + 1;
+      char *c;
+      int bytes = 0;
+      unsigned int b;
+      int n;
+
+      while (sscanf(p, "%2x%n", &b, &n) == 1 && n == 2 && p[2] == ' ')
+      {
+        bytes++;
+        p += 3;
+      }
+      while (*p == ' ')
+        p++;
+      if (*p != '\t' || !bytes || insns >= MAX_INSNS)
+        continue;
+      p++;
+
+      memset(in, 0, sizeof(*in));
+      in->addr = addr;
+      in->size = bytes;
+      in->target = -1;
+      if (sscanf(p, "%7s%n", in->mnem, &n) != 1 || in->mnem[0] == '.')
+        continue;
+      p += n;
+      while (*p == '\t' || *p == ' ')
+        p++;
+      if ((c = strchr(p, ';')))
+      {
+        unsigned long target;
+
+        if (sscanf(c + 1, " 0x%lx", &target) == 1)
+          in->target = target;
+        *c = 0;
+      }
+      strncpy(in->ops, p, sizeof(in->ops) - 1);
+      c = in->ops + strlen(in->ops);
+      while (c > in->ops && (c[-1] == ' ' || c[-1] == '\t' || c[-1] == '\n'))
+        *--c = 0;
+
+      // relative jumps without a comment
+      if (in->target < 0 && (in->ops[0] == '.') && (in->ops[1] == '+' || in->ops[1] == '-'))
+        in->target = addr + 2 + strtol(in->ops + 1, NULL, 0);
+
+      insns++;
+    }
+  }
+  fclose(f);
+
+  return 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: find_insn                                                      */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - addr: byte address                                               */
+/*  Return value:                                                            */
+/*        - index of the instruction, -1 if there is none at the address     */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    binary search, the instructions of the listing are in address order    */
+/*===========================================================================*/
+static int find_insn(long addr)
+{
+  int lo = 0;
+  int hi = insns - 1;
+
+  while (lo <= hi)
+  {
+    int mid = (lo + hi) / 2;
+
+    if (insn[mid].addr == addr)
+      return mid;
+    if (insn[mid].addr < addr)
+      lo = mid + 1;
+    else
+      hi = mid - 1;
+  }
+
+  return -1;
+}
+
+
+/*===========================================================================*/
+/*  Function: insn_is                                                        */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - in: instruction                                                  */
+/*        - mnem: mnemonic                                                   */
+/*  Return value:                                                            */
+/*        - non zero if the instruction has the mnemonic                     */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    compares the mnemonic of an instruction                                */
+/*===========================================================================*/
+static int insn_is(const INSN *in, const char *mnem)
+{
+  return !strcmp(in->mnem, mnem);
+}
+
+
+/*===========================================================================*/
+/*  Function: reg_operand                                                    */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - in: instruction                                                  */
+/*        - pos: index of the operand                                        */
+/*  Return value:                                                            */
+/*        - register number, -1 if the operand is not a register             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    reads a register operand (r0..r31, the Y register is r28:r29)          */
+/*===========================================================================*/
+static int reg_operand(const INSN *in, int pos)
+{
+  const char *p = in->ops;
+  int reg;
+
+  while (pos-- > 0 && (p = strchr(p, ',')))
+    p++;
+  if (!p)
+    return -1;
+  while (*p == ' ')
+    p++;
+  if (!strncmp(p, "r", 1) && sscanf(p + 1, "%d", &reg) == 1)
+    return reg;
+  if (!strncmp(p, "r28", 3) || !strncmp(p, "Y", 1))
+    return 28;
+
+  return -1;
+}
+
+
+/*===========================================================================*/
+/*  Function: num_operand                                                    */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - in: instruction                                                  */
+/*        - pos: index of the operand                                        */
+/*  Return value:                                                            */
+/*        - value of the operand, -1 if it is not a number                   */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    reads a numeric operand, an I/O address or an immediate value          */
+/*===========================================================================*/
+static long num_operand(const INSN *in, int pos)
+{
+  const char *p = in->ops;
+  char *end;
+  long value;
+
+  while (pos-- > 0 && (p = strchr(p, ',')))
+    p++;
+  if (!p)
+    return -1;
+  value = strtol(p, &end, 0);
+
+  return end != p ? value : -1;
+}
+
+
+/*===========================================================================*/
+/*  Function: find_frames                                                    */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - none                                                             */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    sets the stack change of every instruction: push and pop by one byte,  */
+/*    rcall .+0 by two, and the frame of a function, which is allocated by   */
+/*    reading the stack pointer to Y, changing it and writing it back        */
+/*===========================================================================*/
+static void find_frames(void)
+{
+  long frame = 0;
+  int i;
+
+  for (i = 0; i < insns; i++)
+  {
+    INSN *in = &insn[i];
+
+    if (insn_is(in, "push"))
+      in->stack = 1;
+    else if (insn_is(in, "pop"))
+      in->stack = -1;
+    else if (insn_is(in, "rcall") && in->target == in->addr + in->size)
+      in->stack = 2;
+    else if (insn_is(in, "in") && reg_operand(in, 0) == 28 && num_operand(in, 1) == IO_SPL)
+      frame = 0;
+    else if ((insn_is(in, "sbiw") || insn_is(in, "subi")) && reg_operand(in, 0) == 28)
+      frame += (signed char)num_operand(in, 1);
+    else if (insn_is(in, "adiw") && reg_operand(in, 0) == 28)
+      frame -= num_operand(in, 1);
+    else if (insn_is(in, "out") && num_operand(in, 0) == IO_SPL)
+    {
+      in->stack = frame;
+      frame = 0;
+    }
+  }
+}
+
+
+/*===========================================================================*/
+/*  Function: min_path                                                       */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - a, b: cycles of two paths, NO_PATH if there is none              */
+/*  Return value:                                                            */
+/*        - the shorter path                                                 */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    minimum of two path lengths, a missing path is left out                */
+/*===========================================================================*/
+static long min_path(long a, long b)
+{
+  if (a == NO_PATH)
+    return b;
+  if (b == NO_PATH)
+    return a;
+
+  return a < b ? a : b;
+}
+
+
+/*===========================================================================*/
+/*  Function: max_path                                                       */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - a, b: cycles of two paths, NO_PATH if there is none              */
+/*  Return value:                                                            */
+/*        - the longer path                                                  */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    maximum of two path lengths, a missing path is left out                */
+/*===========================================================================*/
+static long max_path(long a, long b)
+{
+  return a > b ? a : b;
+}
+
+
+/*===========================================================================*/
+/*  Function: analyze                                                        */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - i: index of the instruction                                      */
+/*  Return value:                                                            */
+/*        - cycles and stack depth from the instruction to the return        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    walks every path from the instruction to the return of its function,   */
+/*    the called functions are analysed the same way                         */
+/*    the cycle counts are those of the AVR core of the tinyAVR devices:     */
+/*    taken branches and skips cost one more cycle (two for a skipped two    */
+/*    word instruction), the rest has a fixed count                          */
+/*    a jump back to an instruction of the path being walked is a loop, the  */
+/*    loop is counted once and the result is marked, so the worst case is a  */
+/*    lower bound then, indirect jumps and calls are marked too              */
+/*===========================================================================*/
+static RESULT analyze(int i)
+{
+  RESULT r = { 0, 0, NO_PATH, NO_PATH, 0, 0, 0 };
+  RESULT a, b;
+  const INSN *in;
+  long cycles = 1;
+  int next;
+
+  if (i < 0 || i >= insns)
+    return r;
+  if (state[i] == STATE_BUSY)
+  {
+    r.loop = 1;
+    return r;
+  }
+  if (state[i] == STATE_DONE)
+    return memo[i];
+  state[i] = STATE_BUSY;
+
+  in = &insn[i];
+  next = i + 1 < insns && insn[i + 1].addr == in->addr + in->size ? i + 1 : -1;
+
+  if (insn_is(in, "ret") || insn_is(in, "reti"))
+  {
+    r.best = r.worst = 4;
+  }
+  else if (!strncmp(in->mnem, "br", 2))
+  {
+    // conditional branch: 1 cycle if not taken, 2 if taken
+    a = analyze(next);
+    b = analyze(find_insn(in->target));
+    r.best = min_path(1 + a.best, 2 + b.best);
+    r.worst = max_path(1 + a.worst, 2 + b.worst);
+    r.port_best = min_path(a.port_best == NO_PATH ? NO_PATH : 1 + a.port_best,
+                           b.port_best == NO_PATH ? NO_PATH : 2 + b.port_best);
+    r.port_worst = max_path(a.port_worst == NO_PATH ? NO_PATH : 1 + a.port_worst,
+                            b.port_worst == NO_PATH ? NO_PATH : 2 + b.port_worst);
+    r.stack = a.stack > b.stack ? a.stack : b.stack;
+    r.loop = a.loop || b.loop;
+    r.indirect = a.indirect || b.indirect;
+  }
+  else if (insn_is(in, "cpse") || insn_is(in, "sbrc") || insn_is(in, "sbrs") ||
+           insn_is(in, "sbic") || insn_is(in, "sbis"))
+  {
+    // skip: 1 cycle if the next instruction is executed, 2 or 3 if skipped
+    int skipped = next >= 0 ? insn[next].size / 2 : 1;
+    int after = next >= 0 && next + 1 < insns ? next + 1 : -1;
+
+    a = analyze(next);
+    b = analyze(after);
+    r.best = min_path(1 + a.best, 1 + skipped + b.best);
+    r.worst = max_path(1 + a.worst, 1 + skipped + b.worst);
+    r.port_best = min_path(a.port_best == NO_PATH ? NO_PATH : 1 + a.port_best,
+                           b.port_best == NO_PATH ? NO_PATH : 1 + skipped + b.port_best);
+    r.port_worst = max_path(a.port_worst == NO_PATH ? NO_PATH : 1 + a.port_worst,
+                            b.port_worst == NO_PATH ? NO_PATH : 1 + skipped + b.port_worst);
+    r.stack = a.stack > b.stack ? a.stack : b.stack;
+    r.loop = a.loop || b.loop;
+    r.indirect = a.indirect || b.indirect;
+  }
+  else if (insn_is(in, "rjmp") || insn_is(in, "jmp"))
+  {
+    cycles = insn_is(in, "rjmp") ? 2 : 3;
+    a = analyze(find_insn(in->target));
+    r = a;
+    r.best += cycles;
+    r.worst += cycles;
+    if (a.port_best != NO_PATH)
+    {
+      r.port_best += cycles;
+      r.port_worst += cycles;
+    }
+  }
+  else if (insn_is(in, "ijmp"))
+  {
+    r.best = r.worst = 2;
+    r.indirect = 1;
+  }
+  else
+  {
+    RESULT call = { 0, 0, NO_PATH, NO_PATH, 0, 0, 0 };
+    int call_stack = 0;
+
+    if (insn_is(in, "rcall") || insn_is(in, "call") || insn_is(in, "icall"))
+    {
+      cycles = insn_is(in, "call") ? 4 : 3;
+      if (insn_is(in, "icall"))
+        call.indirect = 1;
+      else if (in->target != in->addr + in->size)
+      {
+        // the return address is pushed for the called function
+        call = analyze(find_insn(in->target));
+        call_stack = 2 + call.stack;
+      }
+    }
+    else if (insn_is(in, "adiw") || insn_is(in, "sbiw") || insn_is(in, "ld") ||
+             insn_is(in, "ldd") || insn_is(in, "st") || insn_is(in, "std") ||
+             insn_is(in, "lds") || insn_is(in, "sts") || insn_is(in, "push") ||
+             insn_is(in, "pop") || insn_is(in, "sbi") || insn_is(in, "cbi"))
+      cycles = 2;
+    else if (insn_is(in, "lpm") || insn_is(in, "elpm"))
+      cycles = 3;
+
+    a = analyze(next);
+    r.best = cycles + call.best + a.best;
+    r.worst = cycles + call.worst + a.worst;
+    if (insn_is(in, "out") && num_operand(in, 0) == port_addr[port])
+      r.port_best = r.port_worst = cycles;
+    else if (call.port_best != NO_PATH)
+    {
+      r.port_best = cycles + call.port_best;
+      r.port_worst = cycles + call.port_worst;
+    }
+    else if (a.port_best != NO_PATH)
+    {
+      r.port_best = cycles + call.best + a.port_best;
+      r.port_worst = cycles + call.worst + a.port_worst;
+    }
+    r.stack = in->stack + a.stack;
+    if (call_stack > r.stack)
+      r.stack = call_stack;
+    if (r.stack < 0)
+      r.stack = 0;
+    r.loop = call.loop || a.loop;
+    r.indirect = call.indirect || a.indirect;
+  }
+
+  state[i] = STATE_DONE;
+  memo[i] = r;
+
+  return r;
+}
+
+
+/*===========================================================================*/
+/*  Function: analyze_addr                                                   */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - addr: address of a function                                      */
+/*        - p: port whose first write is timed                               */
+/*  Return value:                                                            */
+/*        - cycles and stack depth of the function                           */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    analyses a function from its entry, the memory of the analysis is      */
+/*    cleared for another port                                               */
+/*===========================================================================*/
+static RESULT analyze_addr(long addr, int p)
+{
+  if (p != port)
+  {
+    memset(state, STATE_NEW, sizeof(state));
+    port = p;
+  }
+
+  return analyze(find_insn(addr));
+}
+
+
+/*===========================================================================*/
+/*  Function: report                                                         */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - name: name of the build                                          */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the results of a build, one value in a line: build, item and    */
+/*    value, marked with + if the worst case is a lower bound                */
+/*    the interrupt cycles count from the first instruction of the handler   */
+/*    to the reti, the hardware adds the response and the vector jump        */
+/*    the stack peak is the depth of main() with the deepest handler         */
+/*===========================================================================*/
+static void report(const char *name)
+{
+  RESULT main_r = { 0, 0, NO_PATH, NO_PATH, 0, 0, 0 };
+  int isr_stack = 0;
+  int peak;
+  int f;
+
+  for (f = 0; f < funcs; f++)
+  {
+    if (!strcmp(func[f].name, "main"))
+      main_r = analyze_addr(func[f].addr, 0);
+  }
+
+  printf("%-36s %-28s %6ld\n", name, "flash", size_text + size_data);
+  printf("%-36s %-28s %6ld\n", name, "ram", size_data + size_bss + size_noinit);
+
+  for (f = 0; f < funcs; f++)
+  {
+    char item[NAME_LEN + 16];
+    const char *isr;
+    const char *mark;
+    RESULT r;
+    RESULT rp;
+    int num;
+    int p;
+
+    if (sscanf(func[f].name, "__vector_%d", &num) != 1 || num <= 0 || num >= MAX_VECTORS)
+      continue;
+
+    isr = vector_name[num][0] ? vector_name[num] : func[f].name;
+    r = analyze_addr(func[f].addr, 0);
+    mark = r.loop || r.indirect ? " +" : "";
+
+    snprintf(item, sizeof(item), "%s.best", isr);
+    printf("%-36s %-28s %6ld\n", name, item, r.best);
+    snprintf(item, sizeof(item), "%s.worst", isr);
+    printf("%-36s %-28s %6ld%s\n", name, item, r.worst, mark);
+    for (p = 0; p < ports; p++)
+    {
+      rp = p ? analyze_addr(func[f].addr, p) : r;
+      if (rp.port_best == NO_PATH)
+        continue;
+      snprintf(item, sizeof(item), "%s.%s.best", isr, port_name[p]);
+      printf("%-36s %-28s %6ld\n", name, item, rp.port_best);
+      snprintf(item, sizeof(item), "%s.%s.worst", isr, port_name[p]);
+      printf("%-36s %-28s %6ld%s\n", name, item, rp.port_worst, mark);
+    }
+    snprintf(item, sizeof(item), "%s.stack", isr);
+    printf("%-36s %-28s %6d\n", name, item, 2 + r.stack);
+
+    if (2 + r.stack > isr_stack)
+      isr_stack = 2 + r.stack;
+  }
+
+  // main() is called from the start-up code
+  peak = 2 + main_r.stack + isr_stack;
+  printf("%-36s %-28s %6d\n", name, "stack", peak);
+  if (ram_start >= 0 && ram_end >= 0)
+    printf("%-36s %-28s %6ld\n", name, "free",
+           ram_end - ram_start + 1 - (size_data + size_bss + size_noinit) - peak);
+}
+
+
+/*===========================================================================*/
+/*  Function: compare                                                        */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - baseline: report of the baseline                                 */
+/*        - current: report of the current build                             */
+/*  Return value:                                                            */
+/*        - number of regressions                                            */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the values changed since the baseline, a larger value is a      */
+/*    regression, except for the free RAM, where a smaller one is            */
+/*===========================================================================*/
+static int compare(const char *baseline, const char *current)
+{
+  static struct
+  {
+    char build[NAME_LEN];
+    char item[NAME_LEN + 16];
+    long value;
+  } base[MAX_LINES];
+  FILE *f;
+  char line[256];
+  int lines = 0;
+  int regressions = 0;
+  int changes = 0;
+
+  if (!(f = fopen(baseline, "r")))
+  {
+    perror(baseline);
+    return -1;
+  }
+  while (lines < MAX_LINES && fgets(line, sizeof(line), f))
+    if (sscanf(line, "%63s %79s %ld", base[lines].build, base[lines].item, &base[lines].value) == 3)
+      lines++;
+  fclose(f);
+
+  if (!(f = fopen(current, "r")))
+  {
+    perror(current);
+    return -1;
+  }
+  while (fgets(line, sizeof(line), f))
+  {
+    char build[NAME_LEN];
+    char item[NAME_LEN + 16];
+    long value;
+    int i;
+
+    if (sscanf(line, "%63s %79s %ld", build, item, &value) != 3)
+      continue;
+    for (i = 0; i < lines; i++)
+      if (!strcmp(base[i].build, build) && !strcmp(base[i].item, item))
+        break;
+
+    if (i == lines)
+    {
+      printf("new:        %-36s %-28s %6ld\n", build, item, value);
+      changes++;
+    }
+    else if (value != base[i].value)
+    {
+      int worse = strcmp(item, "free") ? value > base[i].value : value < base[i].value;
+
+      printf("%-11s %-36s %-28s %6ld -> %ld\n", worse ? "regression:" : "improved:",
+             build, item, base[i].value, value);
+      regressions += worse;
+      changes++;
+    }
+  }
+  fclose(f);
+
+  printf("%d change(s), %d regression(s) since the baseline\n", changes, regressions);
+
+  return regressions;
+}
+
+
+/**** global functions *******************************************************/
+
+/*===========================================================================*/
+/*  Function: main                                                           */
+/*  Module:   isrstat                                                        */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - argc, argv: command line                                         */
+/*  Return value:                                                            */
+/*        - exit status                                                      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    isrstat [-n build] [-d device.h] [-p port]... listing.lss              */
+/*      prints the report of a build, the first writes of the ports given    */
+/*      are timed, of PORTB if none                                          */
+/*    isrstat -c baseline report                                             */
+/*      compares a report with the baseline, fails on regressions            */
+/*===========================================================================*/
+int main(int argc, char *argv[])
+{
+  const char *name = "build";
+  const char *device = NULL;
+  const char *baseline = NULL;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:d:p:c:h")) != -1)
+  {
+    switch (opt)
+    {
+      case 'n': name = optarg; break;
+      case 'd': device = optarg; break;
+      case 'p':
+        if (ports < MAX_PORTS)
+          snprintf(port_name[ports++], sizeof(port_name[0]), "%s", optarg);
+        break;
+      case 'c': baseline = optarg; break;
+      default:
+        fprintf(stderr, "usage: %s [-n build] [-d device.h] [-p port]... listing.lss\n"
+                        "       %s -c baseline report\n", argv[0], argv[0]);
+        return 2;
+    }
+  }
+  if (!ports)
+    ports = 1;
+  if (optind != argc - 1)
+  {
+    fprintf(stderr, "%s: one input file is needed\n", argv[0]);
+    return 2;
+  }
+
+  if (baseline)
+    return compare(baseline, argv[optind]) ? 1 : 0;
+
+  if ((device && read_symbols(device)) || read_listing(argv[optind]))
+    return 1;
+  if (!insns)
+  {
+    fprintf(stderr, "%s: no instructions in %s\n", argv[0], argv[optind]);
+    return 1;
+  }
+
+  find_frames();
+  report(name);
+
+  return 0;
+}
@@ -0,0 +1,92 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: telemetry.c                                                     */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - host decoder of the telemetry of the TELEMETRY option                 */
+/*     reads the bytes sent by the firmware from a file, or from a serial    */
+/*     port set up for 9600 baud 8N1 raw input (stty), and prints a line     */
+/*     for every record, optionally with the time it was received            */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - first implementation                                      */
+/*                                                                           */
+/*****************************************************************************/
+
+/**** include files **********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "telemetry.h"
+
+/**** global functions *******************************************************/
+
+/*===========================================================================*/
+/*  Function: main                                                           */
+/*  Module:   telemetry                                                      */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - argc, argv: command line                                         */
+/*  Return value:                                                            */
+/*        - exit status                                                      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    decodes the input until its end, the decoder needs the build options   */
+/*    of the firmware for the tick and the clock; the first record after a   */
+/*    reset is TLM_RESET, the input shall start there                        */
+/*===========================================================================*/
+int main(int argc, char *argv[])
+{
+  TLM_DECODER dec = { { 0 }, 0 };
+  FILE *in = stdin;
+  int timed = 0;
+  struct timespec start;
+  struct timespec now;
+  int opt;
+  int c;
+
+  while ((opt = getopt(argc, argv, "th")) != -1)
+  {
+    switch (opt)
+    {
+      case 't': timed = 1; break;
+      default:
+        fprintf(stderr, "usage: %s [-t] [file]\n"
+                        "  -t            print the time of every record\n", argv[0]);
+        return 2;
+    }
+  }
+  if (optind < argc && !(in = fopen(argv[optind], "rb")))
+  {
+    perror(argv[optind]);
+    return 1;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  while ((c = fgetc(in)) != EOF)
+  {
+    if (!tlm_decode(&dec, (uint8_t)c))
+      continue;
+    if (timed)
+    {
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      printf("%.3f ", (double)(now.tv_sec - start.tv_sec) +
+                      (now.tv_nsec - start.tv_nsec) / 1e9);
+    }
+    tlm_print(&dec, stdout);
+    fflush(stdout);
+  }
+
+  return 0;
+}
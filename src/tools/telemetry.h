@@ -0,0 +1,164 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: telemetry.h                                                     */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - decoder of the telemetry records of the TELEMETRY option, shared by   */
+/*     the host decoder (telemetry.c) and the simulator, the records are     */
+/*     collected from the bytes received, and printed as a line of text      */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - first implementation                                      */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+/**** include files **********************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "config.h"
+
+/**** types ******************************************************************/
+
+// record being received: header and payload, bytes received
+typedef struct
+{
+  uint8_t record[16];
+  uint8_t size;
+} TLM_DECODER;
+
+/**** constants **************************************************************/
+
+static const char *const tlm_codes[8] =
+{
+  "MO", "MOE", "MOI", "MOS", "MOH", "MO5", "S", "MSG"
+};
+
+// reset flags of MCUSR, from bit 0
+static const char *const tlm_resets[4] =
+{
+  "power-on", "external", "brown-out", "watchdog"
+};
+
+/**** functions **************************************************************/
+
+/*===========================================================================*/
+/*  Function: tlm_decode                                                     */
+/*  Module:   telemetry                                                      */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - dec: decoder state                                               */
+/*        - byte: byte received                                              */
+/*  Return value:                                                            */
+/*        - 1 if a record is complete, 0 otherwise                           */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    the size of the record is given by its header                          */
+/*===========================================================================*/
+static int tlm_decode(TLM_DECODER *dec, uint8_t byte)
+{
+  dec->record[dec->size++] = byte;
+  if (dec->size < 1 + TLM_SIZE(dec->record[0]))
+    return 0;
+
+  dec->size = 0;
+  return 1;
+}
+
+
+/*===========================================================================*/
+/*  Function: tlm_word                                                       */
+/*  Module:   telemetry                                                      */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - data: 16 bit value, low byte first                               */
+/*  Return value:                                                            */
+/*        - the value                                                        */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*===========================================================================*/
+static unsigned tlm_word(const uint8_t *data)
+{
+  return data[0] | (unsigned)data[1] << 8;
+}
+
+
+/*===========================================================================*/
+/*  Function: tlm_print                                                      */
+/*  Module:   telemetry                                                      */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - dec: decoder state, with a complete record                       */
+/*        - out: output file                                                 */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the record as a line, the ticks in seconds and the cycles in    */
+/*    microseconds too, a record of an unknown type or size in hexadecimal   */
+/*===========================================================================*/
+static void tlm_print(const TLM_DECODER *dec, FILE *out)
+{
+  const uint8_t *data = dec->record + 1;
+  uint8_t size = TLM_SIZE(dec->record[0]);
+  unsigned value;
+  int i;
+
+  switch (dec->record[0])
+  {
+    case TLM_HEADER(TLM_RESET, 1):
+      fprintf(out, "reset, MCUSR 0x%02x", data[0]);
+      for (i = 0; i < 4; i++)
+        if (data[0] & (1 << i))
+          fprintf(out, " %s", tlm_resets[i]);
+      break;
+
+    case TLM_HEADER(TLM_CONFIG, 8):
+      fprintf(out, "config %s %s", tlm_codes[data[0] & 7], data[1] ? "fast" : "slow");
+      if (tlm_word(data + 4))
+        fprintf(out, ", enable period %.3f s, interval %.3f s, offset %.3f s",
+                tlm_word(data + 2) / (double)TICKS_PER_SECOND,
+                tlm_word(data + 4) / (double)TICKS_PER_SECOND,
+                tlm_word(data + 6) / (double)TICKS_PER_SECOND);
+      else
+        fprintf(out, ", continuous");
+      break;
+
+    case TLM_HEADER(TLM_WINDOW_START, 0):
+      fprintf(out, "window start");
+      break;
+
+    case TLM_HEADER(TLM_WINDOW_STOP, 0):
+      fprintf(out, "window end");
+      break;
+
+    case TLM_HEADER(TLM_ISR, 2):
+      value = tlm_word(data);
+      fprintf(out, "tick interrupt %u cycles (%.1f us)", value, value * 1e6 / F_CLK);
+      break;
+
+    case TLM_HEADER(TLM_LOST, 1):
+      fprintf(out, "%u records lost", data[0]);
+      break;
+
+    default:
+      fprintf(out, "record");
+      for (i = 0; i <= size; i++)
+        fprintf(out, " %02x", dec->record[i]);
+  }
+  fputc('\n', out);
+}
+
+#endif /*__TELEMETRY_H__*/
@@ -0,0 +1,677 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Filename: trace.c                                                         */
+/* Begin:    2026-10-16                                                      */
+/* Author:   Kertész Csaba-Zoltán                                            */
+/* E-mail:   csaba.kertesz@unitbv.ro                                         */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Description                                                               */
+/*   - host decoder of the EEPROM trace log of the TRACE option              */
+/*     reads the EEPROM, as saved by the programmer or the simulator in      */
+/*     Intel HEX, or as a binary image, puts the blocks of the log in order  */
+/*     and rebuilds the windows from the records                             */
+/*   - prints the sign grid conformance of the windows: the error of every   */
+/*     start from the cycle of the set and of its length from the enable     */
+/*     period, its key edges and their signature, and whether the keying is  */
+/*     the same as in the window before; the times are ticks of the fox, so  */
+/*     these tell a fox which does not follow its own grid, not its drift    */
+/*   - the drift of the fox from a reference is given at the sync edges,     */
+/*     from its phase at the edge, if the pulses come at whole cycles        */
+/*                                                                           */
+/*****************************************************************************/
+/*                                                                           */
+/* Change history:                                                           */
+/*                                                                           */
+/*   2026.10.16: - first implementation                                      */
+/*                                                                           */
+/*****************************************************************************/
+
+/**** include files **********************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+
+/**** local types ************************************************************/
+
+// state of the decoder
+typedef struct
+{
+  // time in ticks since the start, not known after a start of
+  // TRACE_MAX_TICKS or a run with no settings
+  long time;
+  int time_known;
+  // settings of the last config record
+  int config_known;
+  int code;
+  int speed;
+  long enable_period;
+  long interval;
+  // start of the first window after the start record, from its interval
+  // counter, known with the settings
+  int first_known;
+  long first;
+  // phase of the fox at the sync edge before the start
+  int phase_known;
+  long phase_ticks;
+  int phase_count;
+  // reference of the runs, the last whole window, records lost since it
+  int ref_known;
+  long ref_edges;
+  long ref_length;
+  long ref_signature;
+  int lost;
+  // windows of the start: on the grid, deviating, largest errors
+  long windows;
+  long conforming;
+  long deviating;
+  long start_max;
+  long length_max;
+  // the header of the window lines is due before the next one
+  int header;
+} TRACE_DECODER;
+
+/**** local function prototypes **********************************************/
+static void usage(const char *name);
+static long load_hex(FILE *in, uint8_t *image, long size);
+static void print_ms(const char *format, double ticks);
+static void print_header(TRACE_DECODER *dec);
+static void session_end(TRACE_DECODER *dec);
+static void print_phase(TRACE_DECODER *dec, long counter);
+static void window(TRACE_DECODER *dec, const uint8_t *record);
+static void run(TRACE_DECODER *dec, int count);
+static void decode(TRACE_DECODER *dec, const uint8_t *record);
+
+/**** constants **************************************************************/
+
+#define IMAGE_SIZE 4096
+
+static const char *const codes[8] =
+{
+  "MO", "MOE", "MOI", "MOS", "MOH", "MO5", "S", "MSG"
+};
+
+// reset flags of MCUSR, from bit 0
+static const char *const resets[4] =
+{
+  "power-on", "external", "brown-out", "watchdog"
+};
+
+/**** local variables ********************************************************/
+
+static int every;
+
+/**** local functions ********************************************************/
+
+/*===========================================================================*/
+/*  Function: usage                                                          */
+/*  Module:   trace                                                          */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - name: program name                                               */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the command line help                                           */
+/*===========================================================================*/
+static void usage(const char *name)
+{
+  fprintf(stderr,
+          "usage: %s [options] [file]\n"
+          "  -a address    address of the log in the EEPROM (default: 0)\n"
+          "  -n blocks     blocks of the log (default: %d)\n"
+          "  -b            binary EEPROM image instead of Intel HEX\n"
+          "  -l            print every window of the runs, not only a line\n",
+          name, TRACE_BLOCKS);
+}
+
+
+/*===========================================================================*/
+/*  Function: load_hex                                                       */
+/*  Module:   trace                                                          */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - in: input file                                                   */
+/*        - image: EEPROM image                                              */
+/*        - size: size of the image                                          */
+/*  Return value:                                                            */
+/*        - bytes of the image loaded, -1 on error                           */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    reads the data records of an Intel HEX file until its end record, the  */
+/*    checksum of every record is checked                                    */
+/*===========================================================================*/
+static long load_hex(FILE *in, uint8_t *image, long size)
+{
+  char line[600];
+  unsigned bytes[256];
+  unsigned count, addr, type;
+  long end = 0;
+  unsigned sum;
+  unsigned i;
+
+  while (fgets(line, sizeof(line), in))
+  {
+    if (line[0] != ':')
+      continue;
+    if (sscanf(line + 1, "%2x%4x%2x", &count, &addr, &type) != 3)
+      return -1;
+    sum = count + (addr >> 8) + (addr & 0xFF) + type;
+    for (i = 0; i <= count; i++)
+    {
+      if (sscanf(line + 9 + 2 * i, "%2x", &bytes[i]) != 1)
+        return -1;
+      sum += bytes[i];
+    }
+    if (sum & 0xFF)
+      return -1;
+    if (type == 1)
+      break;
+    if (type != 0)
+      continue;
+    for (i = 0; i < count; i++)
+    {
+      if (addr + i >= (unsigned long)size)
+        return -1;
+      image[addr + i] = (uint8_t)bytes[i];
+    }
+    if (addr + count > (unsigned long)end)
+      end = addr + count;
+  }
+
+  return end;
+}
+
+
+/*===========================================================================*/
+/*  Function: print_ms                                                       */
+/*  Module:   trace                                                          */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - format: printf format of the value in milliseconds               */
+/*        - ticks: value in ticks                                            */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*===========================================================================*/
+static void print_ms(const char *format, double ticks)
+{
+  printf(format, ticks * 1000 / TICKS_PER_SECOND);
+}
+
+
+/*===========================================================================*/
+/*  Function: print_header                                                   */
+/*  Module:   trace                                                          */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - dec: decoder state                                               */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the header of the window lines before the first one of a start  */
+/*===========================================================================*/
+static void print_header(TRACE_DECODER *dec)
+{
+  if (!dec->header)
+    return;
+  dec->header = 0;
+  printf("%6s %10s %9s %9s %6s %6s\n", "window", "start s", "start ms",
+         "length ms", "edges", "signature");
+}
+
+
+/*===========================================================================*/
+/*  Function: session_end                                                    */
+/*  Module:   trace                                                          */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - dec: decoder state                                               */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the summary of the start: the windows on the grid, the ones     */
+/*    deviating from it and the largest errors                               */
+/*===========================================================================*/
+static void session_end(TRACE_DECODER *dec)
+{
+  if (dec->windows)
+  {
+    printf("%ld windows, %ld on the grid, %ld deviating", dec->windows,
+           dec->conforming, dec->deviating);
+    print_ms(", start error max %.1f ms", dec->start_max);
+    print_ms(", length error max %.1f ms\n", dec->length_max);
+  }
+
+  dec->windows = 0;
+  dec->conforming = 0;
+  dec->deviating = 0;
+  dec->start_max = 0;
+  dec->length_max = 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: print_phase                                                    */
+/*  Module:   trace                                                          */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - dec: decoder state                                               */
+/*        - counter: interval counter set by the sync edge                   */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the drift of the fox at a sync edge: a fox on time has counted  */
+/*    the counter set by the edge and the whole tick before the one the edge */
+/*    starts, its phase is taken to the nearest whole cycle                  */
+/*===========================================================================*/
+static void print_phase(TRACE_DECODER *dec, long counter)
+{
+  double drift;
+
+  if (!dec->phase_known)
+    return;
+  dec->phase_known = 0;
+
+  if (dec->phase_count == TRACE_PHASE_UNKNOWN)
+  {
+    printf("  phase at the edge not known, in power-down\n");
+    return;
+  }
+  if (!dec->config_known || !dec->interval)
+  {
+    printf("  phase at the edge: interval counter %ld, Timer0 count %d\n",
+           dec->phase_ticks, dec->phase_count);
+    return;
+  }
+
+  drift = dec->phase_ticks + (double)dec->phase_count / TIMER0_TICK_COUNTS - counter - 1;
+  drift -= dec->interval * floor(drift / dec->interval + 0.5);
+  print_ms("  drift from the sync reference %+.3f ms\n", drift);
+}
+
+
+/*===========================================================================*/
+/*  Function: window                                                         */
+/*  Module:   trace                                                          */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - dec: decoder state                                               */
+/*        - record: TRACE_WINDOW or TRACE_PARTIAL record                     */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    prints the line of a window written whole: its start, its error from   */
+/*    the cycle of the set, the first one after a start from the interval    */
+/*    counter, the error of its length, its edges and signature, and if the  */
+/*    keying changed; a whole window is the reference of the runs after it,  */
+/*    a partial one opens at the start of the trace                          */
+/*===========================================================================*/
+static void window(TRACE_DECODER *dec, const uint8_t *record)
+{
+  long start = record[1] | (long)record[2] << 8;
+  long length = record[3] | (long)record[4] << 8;
+  long edges = record[5] | (long)record[6] << 8;
+  long signature = record[7] | (long)record[8] << 8;
+  int grid = dec->config_known && dec->interval;
+  int deviates = 0;
+  long error;
+
+  print_header(dec);
+  if (record[0] == TRACE_PARTIAL)
+  {
+    printf("%6s %10.3f %9s", "-", 0.0, "-");
+    if (grid)
+      print_ms(" %+9.1f", length - dec->enable_period);
+    else
+      printf(" %9s", "-");
+    printf(" %6ld   %04lx  partial, open at the start\n", edges, signature);
+    dec->time = 0;
+    return;
+  }
+
+  dec->time += start;
+  if (start == TRACE_MAX_TICKS)
+    dec->time_known = 0;
+  dec->windows++;
+  printf("%6ld", dec->windows);
+  if (dec->time_known)
+    printf(" %10.3f", dec->time / (double)TICKS_PER_SECOND);
+  else
+    printf(" %10s", "-");
+
+  if (start == TRACE_MAX_TICKS)
+  {
+    printf(" %9s", "long");
+    deviates = 1;
+  }
+  else if (!grid || (dec->windows == 1 && !dec->first_known))
+  {
+    printf(" %9s", "-");
+  }
+  else
+  {
+    error = start - (dec->windows == 1 ? dec->first : dec->interval);
+    print_ms(" %+9.1f", error);
+    deviates = error != 0;
+    if (labs(error) > dec->start_max)
+      dec->start_max = labs(error);
+  }
+
+  if (grid)
+  {
+    error = length - dec->enable_period;
+    print_ms(" %+9.1f", error);
+    deviates |= error != 0;
+    if (labs(error) > dec->length_max)
+      dec->length_max = labs(error);
+  }
+  else
+  {
+    printf(" %9s", "-");
+  }
+  printf(" %6ld   %04lx", edges, signature);
+
+  if (dec->ref_known && !dec->lost &&
+      (length != dec->ref_length || edges != dec->ref_edges || signature != dec->ref_signature))
+  {
+    printf("  keying changed");
+    deviates = 1;
+  }
+  printf("%s\n", dec->lost ? "  records lost before" : "");
+  if (deviates)
+    dec->deviating++;
+  else
+    dec->conforming++;
+
+  dec->ref_known = 1;
+  dec->ref_edges = edges;
+  dec->ref_length = length;
+  dec->ref_signature = signature;
+  dec->lost = 0;
+}
+
+
+/*===========================================================================*/
+/*  Function: run                                                            */
+/*  Module:   trace                                                          */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - dec: decoder state                                               */
+/*        - count: windows of the run                                        */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    a run of windows the same as the reference, each an interval after     */
+/*    the one before, all on the grid; printed in a line, or with -l every   */
+/*    window in its own                                                      */
+/*===========================================================================*/
+static void run(TRACE_DECODER *dec, int count)
+{
+  int i;
+
+  print_header(dec);
+  if (!every)
+    printf("%6ld %10s %d window%s the same%s, one interval apart\n", dec->windows + 1, "",
+           count, count == 1 ? "" : "s", dec->ref_known ? "" : " as one before the log");
+  for (i = 0; i < count; i++)
+  {
+    dec->windows++;
+    dec->conforming++;
+    if (dec->config_known && dec->interval)
+      dec->time += dec->interval;
+    else
+      dec->time_known = 0;
+    if (!every)
+      continue;
+
+    printf("%6ld", dec->windows);
+    if (dec->time_known)
+      printf(" %10.3f", dec->time / (double)TICKS_PER_SECOND);
+    else
+      printf(" %10s", "-");
+    printf(" %+9.1f %+9.1f", 0.0, 0.0);
+    if (dec->ref_known)
+      printf(" %6ld   %04lx  same\n", dec->ref_edges, dec->ref_signature);
+    else
+      printf(" %6s   %4s  same\n", "-", "-");
+  }
+}
+
+
+/*===========================================================================*/
+/*  Function: decode                                                         */
+/*  Module:   trace                                                          */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - dec: decoder state                                               */
+/*        - record: record of the log                                        */
+/*  Return value:                                                            */
+/*        - none                                                             */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    applies a record: a start ends the windows before it, and gives the    */
+/*    start of the first window from the interval counter, at a sync edge    */
+/*    the drift from the phase before it                                     */
+/*===========================================================================*/
+static void decode(TRACE_DECODER *dec, const uint8_t *record)
+{
+  unsigned flags;
+  long counter;
+  int i;
+
+  switch (record[0])
+  {
+    case TRACE_START:
+      session_end(dec);
+      flags = record[1];
+      counter = record[2] | (long)record[3] << 8;
+      printf("start:");
+      if (flags & TRACE_SYNC)
+        printf(" sync edge");
+      if (flags & TRACE_SCHED)
+        printf(" schedule window");
+      for (i = 0; i < 4; i++)
+        if (flags & (1 << i))
+          printf(" %s", resets[i]);
+      if (!flags)
+        printf(" reset");
+      printf(", interval counter %ld\n", counter);
+      if (flags & TRACE_SYNC)
+        print_phase(dec, counter);
+      dec->header = 1;
+      dec->time = 0;
+      dec->time_known = 1;
+      dec->ref_known = 0;
+      dec->first_known = dec->config_known && dec->interval;
+      if (dec->first_known)
+        dec->first = (dec->interval - counter % dec->interval) % dec->interval;
+      break;
+
+    case TRACE_PHASE:
+      dec->phase_known = 1;
+      dec->phase_ticks = record[1] | (long)record[2] << 8;
+      dec->phase_count = record[3];
+      break;
+
+    case TRACE_CONFIG:
+      if (dec->config_known && dec->code == record[1] && dec->speed == record[2] &&
+          dec->enable_period == (record[3] | (long)record[4] << 8) &&
+          dec->interval == (record[5] | (long)record[6] << 8))
+        break;
+      dec->config_known = 1;
+      dec->code = record[1];
+      dec->speed = record[2];
+      dec->enable_period = record[3] | (long)record[4] << 8;
+      dec->interval = record[5] | (long)record[6] << 8;
+      printf("config %s %s", codes[record[1] & 7], record[2] ? "fast" : "slow");
+      if (dec->interval)
+        printf(", enable period %.3f s, interval %.3f s",
+               dec->enable_period / (double)TICKS_PER_SECOND,
+               dec->interval / (double)TICKS_PER_SECOND);
+      else
+        printf(", continuous, no window is recorded");
+      printf("\n");
+      break;
+
+    case TRACE_WINDOW:
+    case TRACE_PARTIAL:
+      window(dec, record);
+      break;
+
+    case TRACE_RUN:
+      run(dec, record[1]);
+      break;
+
+    case TRACE_LOST:
+      dec->lost = 1;
+      printf("records lost\n");
+      break;
+
+    default:
+      printf("unknown record 0x%02x\n", record[0]);
+      break;
+  }
+}
+
+
+/**** global functions *******************************************************/
+
+/*===========================================================================*/
+/*  Function: main                                                           */
+/*  Module:   trace                                                          */
+/*===========================================================================*/
+/*  Parameters:                                                              */
+/*        - argc, argv: command line                                         */
+/*  Return value:                                                            */
+/*        - exit status                                                      */
+/*===========================================================================*/
+/*  Description:                                                             */
+/*    loads the EEPROM, orders the valid blocks of the log from the oldest   */
+/*    one by their numbers, relative to the newest one, and decodes their    */
+/*    records; the windows before the first start, left from an older trace, */
+/*    are timed from the first one                                           */
+/*===========================================================================*/
+int main(int argc, char *argv[])
+{
+  static uint8_t image[IMAGE_SIZE];
+  static uint8_t records[127 * TRACE_BLOCK_DATA];
+  TRACE_DECODER dec;
+  FILE *in = stdin;
+  long address = 0;
+  long blocks = TRACE_BLOCKS;
+  long size;
+  long length = 0;
+  int binary = 0;
+  int newest = -1;
+  int age;
+  int opt;
+  long b;
+  long i;
+  const uint8_t *block;
+
+  while ((opt = getopt(argc, argv, "a:n:blh")) != -1)
+  {
+    switch (opt)
+    {
+      case 'a': address = strtol(optarg, NULL, 0); break;
+      case 'n': blocks = strtol(optarg, NULL, 0); break;
+      case 'b': binary = 1; break;
+      case 'l': every = 1; break;
+      default: usage(argv[0]); return 2;
+    }
+  }
+  if (blocks < 2 || blocks > 127 || address < 0 ||
+      address + blocks * TRACE_BLOCK_SIZE > IMAGE_SIZE)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+  if (optind < argc && !(in = fopen(argv[optind], binary ? "rb" : "r")))
+  {
+    perror(argv[optind]);
+    return 1;
+  }
+
+  memset(image, 0xFF, sizeof(image));
+  size = binary ? (long)fread(image, 1, sizeof(image), in) : load_hex(in, image, sizeof(image));
+  if (size < 0)
+  {
+    fprintf(stderr, "%s: bad Intel HEX record\n", argv[0]);
+    return 1;
+  }
+  if (size < address + blocks * TRACE_BLOCK_SIZE)
+  {
+    fprintf(stderr, "%s: the EEPROM ends before the log\n", argv[0]);
+    return 1;
+  }
+
+  // the newest block, as found by the firmware
+  for (b = 0; b < blocks; b++)
+  {
+    block = image + address + b * TRACE_BLOCK_SIZE;
+    if (block[1] > TRACE_BLOCK_DATA)
+      continue;
+    if (newest < 0 || (int8_t)(block[0] - image[address + newest * TRACE_BLOCK_SIZE]) > 0)
+      newest = (int)b;
+  }
+  if (newest < 0)
+  {
+    printf("no trace\n");
+    return 0;
+  }
+
+  // the blocks from the oldest one, their numbers are within the blocks of
+  // the log before the newest one
+  for (age = (int)blocks - 1; age >= 0; age--)
+  {
+    for (b = 0; b < blocks; b++)
+    {
+      block = image + address + b * TRACE_BLOCK_SIZE;
+      if (block[1] > TRACE_BLOCK_DATA ||
+          (uint8_t)(image[address + newest * TRACE_BLOCK_SIZE] - block[0]) != age)
+        continue;
+      memcpy(records + length, block + 2, block[1]);
+      length += block[1];
+    }
+  }
+
+  memset(&dec, 0, sizeof(dec));
+  dec.time_known = 1;
+  printf("%ld bytes of records; sign grid conformance, in the ticks of the fox,\n"
+         "the drift from a reference only at the sync edges\n", length);
+  for (i = 0; i < length && records[i] == TRACE_CONFIG; i += TRACE_SIZE(TRACE_CONFIG))
+    ;
+  if (i < length && records[i] != TRACE_START && records[i] != TRACE_PHASE)
+  {
+    printf("start: before the log, the time from its first window\n");
+    dec.header = 1;
+  }
+  for (i = 0; i < length; i += TRACE_SIZE(records[i]))
+  {
+    if (i + TRACE_SIZE(records[i]) > length)
+      break;
+    // the settings read for a start are put before its record
+    if (records[i] == TRACE_CONFIG && i + TRACE_SIZE(TRACE_CONFIG) < length &&
+        records[i + TRACE_SIZE(TRACE_CONFIG)] == TRACE_START)
+      session_end(&dec);
+    decode(&dec, records + i);
+  }
+  session_end(&dec);
+
+  return 0;
+}